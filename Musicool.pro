@@ -10,22 +10,43 @@ CONFIG += c++17
 
 SOURCES += \
     androidutils.cpp \
+    audioengine.cpp \
+    audiosynth.cpp \
+    clickbank.cpp \
     main.cpp \
     mainwindow.cpp \
+    metronomeengine.cpp \
     metronomewidget.cpp \
+    notescrollwidget.cpp \
+    pitchhistorywidget.cpp \
     pitchtracker.cpp \
+    spectrum.cpp \
+    spectrumwidget.cpp \
     staffnotewidget.cpp \
     tonegenerator.cpp \
-    tunerwidget.cpp
+    tunerwidget.cpp \
+    wavfile.cpp
 
 HEADERS += \
     androidutils.h \
+    audioengine.h \
+    audiosynth.h \
+    clickbank.h \
     mainwindow.h \
+    metronomeengine.h \
     metronomewidget.h \
+    notescrollwidget.h \
+    pitchhistorywidget.h \
     pitchtracker.h \
+    scrollimage.h \
+    spectrum.h \
+    spectrumwidget.h \
+    spscqueue.h \
     staffnotewidget.h \
+    textcache.h \
     tonegenerator.h \
-    tunerwidget.h
+    tunerwidget.h \
+    wavfile.h
 
 FORMS += \
     mainwindow.ui
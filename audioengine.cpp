@@ -0,0 +1,571 @@
+#include "audioengine.h"
+
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QAudioSource>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QThread>
+#include <QtMath>
+#include <algorithm>
+
+static constexpr float kLimitThreshold = 0.89f;   // ~ -1 dBFS
+
+// PCM do microfone (qualquer formato/canais) -> float mono
+static void toMono(const char* data, int frames, const QAudioFormat& fmt, float* out)
+{
+    const int ch = qMax(1, fmt.channelCount());
+    const float inv = 1.0f / float(ch);
+    for (int i = 0; i < frames; ++i) {
+        float s = 0.0f;
+        for (int c = 0; c < ch; ++c) {
+            const int k = i * ch + c;
+            switch (fmt.sampleFormat()) {
+            case QAudioFormat::Float:
+                s += reinterpret_cast<const float*>(data)[k]; break;
+            case QAudioFormat::Int32:
+                s += reinterpret_cast<const qint32*>(data)[k] / 2147483648.0f; break;
+            case QAudioFormat::UInt8:
+                s += (float(reinterpret_cast<const quint8*>(data)[k]) - 128.0f) / 128.0f; break;
+            default:
+                s += reinterpret_cast<const qint16*>(data)[k] / 32768.0f; break;
+            }
+        }
+        out[i] = s * inv;
+    }
+}
+
+// ---------------- stream (pull mode) ----------------
+// A sink puxa os bytes na thread de áudio; o engine mixa as fontes, mede
+// os callbacks e ancora o relógio de saída.
+class AudioEngine::Stream : public QIODevice
+{
+public:
+    Stream(AudioEngine* engine, QObject* parent)
+        : QIODevice(parent), m_engine(engine)
+    {
+        open(QIODevice::ReadOnly);
+    }
+
+    void rearm(double bufferMs) {
+        m_bufferMs = bufferMs;
+        m_lastNs   = -1;
+    }
+
+protected:
+    qint64 readData(char* data, qint64 maxlen) override
+    {
+        // se entre dois pedidos passou mais tempo do que havia na fila da
+        // sink, o device ficou sem áudio
+        const qint64 now = m_engine->m_wall.nsecsElapsed();
+        if (m_lastNs >= 0) {
+            const qint64 gapUs = (now - m_lastNs) / 1000;
+            if (gapUs > m_engine->m_statMaxGapUs.load(std::memory_order_relaxed))
+                m_engine->m_statMaxGapUs.store(gapUs, std::memory_order_relaxed);
+            if (gapUs > m_bufferMs * 1000.0)
+                m_engine->m_statLate.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_lastNs = now;
+
+        const qint64 bytes = m_engine->readBlock(data, maxlen);
+
+        // o que a sink ainda tem para tocar, já contando este bloco
+        const QAudioSink* sink = m_engine->m_sink;
+        const qint64 bpf = qMax(1, m_engine->m_fmt.bytesPerFrame());
+        const qint64 buf = sink->bufferSize();
+        const qint64 queued = qMin(buf, buf - sink->bytesFree() + bytes);
+        m_engine->markPlayed(queued / bpf);
+        m_engine->m_deviceFrames.store(sink->processedUSecs() * m_engine->m_sampleRate / 1000000,
+                                       std::memory_order_release);
+        return bytes;
+    }
+
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    AudioEngine*  m_engine;
+    qint64 m_lastNs   = -1;
+    double m_bufferMs = 1.0e9;
+};
+
+// ---------------- ctor/dtor ----------------
+AudioEngine& AudioEngine::shared()
+{
+    static AudioEngine engine;
+    return engine;
+}
+
+AudioEngine::AudioEngine(QObject* parent)
+    : QObject(parent)
+{
+    m_wall.start();
+}
+
+AudioEngine::~AudioEngine()
+{
+    shutdown();
+}
+
+// ---------------- thread de áudio ----------------
+void AudioEngine::runOnAudioThread(const std::function<void()>& fn)
+{
+    if (!m_thread) {
+        m_thread = new QThread;
+        m_thread->setObjectName(QStringLiteral("audio"));
+        m_ctx = new QObject;
+        m_ctx->moveToThread(m_thread);
+        m_thread->start(QThread::TimeCriticalPriority);
+
+        // o singleton é estático: a thread tem que parar antes do app sumir
+        if (QCoreApplication* app = QCoreApplication::instance())
+            connect(app, &QCoreApplication::aboutToQuit, this, &AudioEngine::shutdown,
+                    Qt::UniqueConnection);
+    }
+    if (QThread::currentThread() == m_thread) { fn(); return; }
+    QMetaObject::invokeMethod(m_ctx, [&fn]{ fn(); }, Qt::BlockingQueuedConnection);
+}
+
+void AudioEngine::shutdown()
+{
+    close();
+    if (!m_thread) return;
+    m_thread->quit();
+    m_thread->wait();
+    delete m_ctx;                        // m_stream vai junto (filho)
+    delete m_thread;
+    m_ctx    = nullptr;
+    m_thread = nullptr;
+    m_stream = nullptr;
+}
+
+// ---------------- device ----------------
+bool AudioEngine::open()
+{
+    if (m_sink) return true;
+
+    const QAudioDevice dev = QMediaDevices::defaultAudioOutput();
+    if (dev.isNull()) return false;
+
+    QAudioFormat fmt;
+    fmt.setSampleRate(m_sampleRate);
+    fmt.setChannelCount(1);
+    fmt.setSampleFormat(QAudioFormat::Int16);
+    if (!dev.isFormatSupported(fmt))
+        fmt = dev.preferredFormat();     // o mix converte para o que vier
+    m_fmt = fmt;
+    m_sampleRate = m_fmt.sampleRate();
+    m_limRel = std::exp(-1.0f / (0.050f * m_sampleRate));
+
+    // sem callback rodando: fontes preparadas aqui, na taxa nova
+    for (AudioSource* s : m_sources) s->prepare(m_sampleRate);
+    const QAudioDevice inDev = m_inputs.isEmpty() ? QAudioDevice() : QMediaDevices::defaultAudioInput();
+
+    runOnAudioThread([this, &dev, &inDev]{
+        while (!m_cmds.isEmpty()) applyCommands();
+        m_activeCount = 0;
+        for (AudioSource* s : m_sources)
+            if (m_activeCount < kMaxSources) m_active[m_activeCount++] = s;
+        m_clock.store(0, std::memory_order_release);
+        markPlayed(0);
+        m_deviceFrames.store(0, std::memory_order_release);
+        m_limEnv = 0.0f;
+
+        // duplex: o microfone abre junto, antes do 1º callback da saída
+        if (!m_inputs.isEmpty() && !openInputDevice(inDev))
+            qWarning() << "[AudioEngine] entrada indisponivel; afinador sem audio";
+
+        m_sink = new QAudioSink(dev, m_fmt, m_ctx);
+        m_sink->setVolume(1.0f);
+
+        // buffer explícito a partir do alvo de latência (o default do backend
+        // costuma ser de centenas de ms)
+        const int bpf    = qMax(1, m_fmt.bytesPerFrame());
+        const int frames = m_sampleRate * m_latencyMs / 1000;
+        m_sink->setBufferSize(qMax(64, frames) * bpf);
+        m_bufferMs = m_fmt.durationForBytes(m_sink->bufferSize()) / 1000.0;
+
+        if (!m_stream) m_stream = new Stream(this, m_ctx);
+        m_stream->rearm(m_bufferMs);
+        m_sink->start(m_stream);
+    });
+
+    qInfo() << "[AudioEngine] open" << m_sampleRate << "Hz," << m_fmt.channelCount()
+            << "ch, buffer" << m_bufferMs << "ms (thread de audio)";
+    return true;
+}
+
+void AudioEngine::close()
+{
+    if (!m_sink) return;
+    runOnAudioThread([this]{
+        closeInputDevice();
+        m_sink->stop();                  // daqui em diante nenhum callback
+        m_sink->deleteLater();
+        m_sink = nullptr;
+        while (!m_cmds.isEmpty()) applyCommands();
+        m_activeCount = 0;
+        m_activeInCount = 0;
+    });
+}
+
+// ---------------- entrada (thread de áudio) ----------------
+bool AudioEngine::openInputDevice(const QAudioDevice& dev)
+{
+    if (m_inIo) return true;
+    if (dev.isNull()) return false;
+
+    // pede a taxa da saída: com as duas iguais o carimbo é só um offset
+    QAudioFormat fmt;
+    fmt.setSampleRate(m_sampleRate);
+    fmt.setChannelCount(1);
+    fmt.setSampleFormat(QAudioFormat::Int16);
+    if (!dev.isFormatSupported(fmt)) fmt = dev.preferredFormat();
+    m_inFmt = fmt;
+    m_inSampleRate = m_inFmt.sampleRate();
+    m_inRatio = double(m_sampleRate) / double(m_inSampleRate);
+
+    m_inSource = new QAudioSource(dev, m_inFmt, m_ctx);
+    const int bpf = qMax(1, m_inFmt.bytesPerFrame());
+    m_inSource->setBufferSize(qMax(kBlock, m_inSampleRate * m_latencyMs / 1000) * bpf);
+    m_inIo = m_inSource->start();
+    if (!m_inIo) {
+        delete m_inSource;
+        m_inSource = nullptr;
+        return false;
+    }
+    m_inRaw.resize(kBlock * bpf);
+    m_inTotal  = 0;
+    m_inLocked = false;
+    connect(m_inIo, &QIODevice::readyRead, m_ctx, [this]{ readInput(); });
+
+    m_activeInCount = 0;
+    for (AudioInput* in : m_inputs) {
+        in->prepare(m_inSampleRate);
+        if (m_activeInCount < kMaxInputs) m_activeIn[m_activeInCount++] = in;
+    }
+    if (m_inSampleRate != m_sampleRate)
+        qInfo() << "[AudioEngine] entrada a" << m_inSampleRate << "Hz (saida" << m_sampleRate << "Hz)";
+    return true;
+}
+
+const AudioRef* AudioEngine::outputRef(qint64 clock, int frames)
+{
+    m_refView = AudioRef();
+
+    // mix nos mesmos samples (só com taxas iguais: o carimbo é exato)
+    const qint64 mixed = m_clock.load(std::memory_order_relaxed);
+    if (m_inRatio == 1.0 && m_lastLoud >= clock
+        && clock >= mixed - kRefFrames && clock + frames <= mixed) {
+        for (int i = 0; i < frames; ++i)
+            m_refOut[i] = m_ref[(clock + i) & (kRefFrames - 1)];
+        m_refView.signal = m_refOut;
+    }
+
+    // clicks que começam dentro do bloco
+    bool any = false;
+    for (int k = 0; k < kTransients; ++k) {
+        const qint64 d = m_trans[k] - clock;
+        if (d < 0 || d >= frames) continue;
+        if (!any) { std::fill(m_transOut, m_transOut + frames, quint8(0)); any = true; }
+        m_transOut[d] = 1;
+    }
+    if (any) m_refView.transient = m_transOut;
+
+    return (m_refView.signal || m_refView.transient) ? &m_refView : nullptr;
+}
+
+void AudioEngine::closeInputDevice()
+{
+    if (!m_inSource) return;
+    m_inSource->stop();
+    m_inSource->deleteLater();
+    m_inSource = nullptr;
+    m_inIo = nullptr;
+    m_activeInCount = 0;
+}
+
+void AudioEngine::readInput()
+{
+    applyCommands();
+    if (!m_inIo) return;
+
+    const int bpf = qMax(1, m_inFmt.bytesPerFrame());
+    for (;;) {
+        const qint64 got = m_inIo->read(m_inRaw.data(), m_inRaw.size());
+        const int frames = int(got / bpf);
+        if (frames <= 0) break;
+
+        // o último frame lido acabou de ser capturado: corresponde ao que a
+        // saída está tocando agora, menos o que ainda espera na fila da
+        // entrada. O offset é suavizado (jitter de callback, deriva entre
+        // os cristais); latência de hardware fica para a calibração.
+        const qint64 pending = m_inIo->bytesAvailable() / bpf;
+        const double measured = double(playedFrames()) - double(pending) * m_inRatio
+                              - double(m_inTotal + frames) * m_inRatio;
+        if (!m_inLocked) { m_inOffset = measured; m_inLocked = sampleClock() > 0; }
+        else             m_inOffset += (measured - m_inOffset) / 64.0;
+
+        toMono(m_inRaw.constData(), frames, m_inFmt, m_inMix);
+        const qint64 clock = qint64(std::llround(double(m_inTotal) * m_inRatio + m_inOffset));
+        const AudioRef* ref = outputRef(clock, frames);
+        for (int i = 0; i < m_activeInCount; ++i)
+            m_activeIn[i]->capture(m_inMix, frames, clock, ref);
+        m_inTotal += frames;
+
+        m_statInFrames.fetch_add(quint64(frames), std::memory_order_relaxed);
+        m_statInOffset.store(m_inOffset, std::memory_order_relaxed);
+    }
+}
+
+void AudioEngine::setLatencyTargetMs(int ms)
+{
+    ms = qBound(10, ms, 200);
+    if (m_latencyMs == ms) return;
+    m_latencyMs = ms;
+
+    // buffer só muda ao recriar a sink
+    if (m_sink) { close(); open(); }
+}
+
+// ---------------- relógio de saída ----------------
+void AudioEngine::markPlayed(qint64 queuedFrames)
+{
+    const quint32 seq = m_playSeq.load(std::memory_order_relaxed);
+    m_playSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_playedAt.store(m_clock.load(std::memory_order_relaxed) - queuedFrames, std::memory_order_relaxed);
+    m_playedNs.store(m_wall.nsecsElapsed(), std::memory_order_relaxed);
+    m_playSeq.store(seq + 2, std::memory_order_release);
+}
+
+qint64 AudioEngine::playedFrames() const
+{
+    qint64 at = 0, ns = 0;
+    for (;;) {
+        const quint32 s0 = m_playSeq.load(std::memory_order_acquire);
+        at = m_playedAt.load(std::memory_order_relaxed);
+        ns = m_playedNs.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!(s0 & 1u) && m_playSeq.load(std::memory_order_relaxed) == s0) break;
+    }
+    // entre callbacks o device segue consumindo em tempo real
+    const qint64 played = at + (m_wall.nsecsElapsed() - ns) * m_sampleRate / 1000000000;
+    return qMin(played, sampleClock());
+}
+
+// ---------------- fontes ----------------
+void AudioEngine::post(Command::Type type, AudioSource* src, AudioInput* in)
+{
+    Command c;
+    c.type = type;
+    c.src  = src;
+    c.in   = in;
+    c.seq  = ++m_posted;
+    if (m_cmds.push(c)) return;
+    // fila cheia (32 comandos: callback travado): em vez de girar esperando
+    // vaga, esvazia a fila e aplica este comando na própria thread de áudio
+    qWarning() << "[AudioEngine] fila de comandos cheia";
+    runOnAudioThread([this, &c]{ applyCommands(); applyCommand(c); });
+}
+
+void AudioEngine::addSource(AudioSource* src)
+{
+    if (!src || m_sources.contains(src)) return;
+    m_sources.append(src);
+    if (!m_sink) return;                 // entra no próximo open()
+    src->prepare(m_sampleRate);
+    post(Command::Add, src);
+}
+
+void AudioEngine::waitApplied()
+{
+    // já aplicado pelo callback: nada a esperar. Senão a thread de áudio
+    // aplica a fila ela mesma; a chamada bloqueante volta no máximo depois do
+    // callback em andamento, sem espera ativa na GUI
+    if (m_applied.load(std::memory_order_acquire) >= m_posted) return;
+    runOnAudioThread([this]{ applyCommands(); });
+}
+
+void AudioEngine::removeSource(AudioSource* src)
+{
+    if (!m_sources.removeAll(src)) return;
+    if (m_sink) {
+        post(Command::Remove, src);
+        waitApplied();
+    }
+    if (m_sources.isEmpty() && m_inputs.isEmpty()) close();
+}
+
+bool AudioEngine::addInput(AudioInput* in)
+{
+    if (!in) return false;
+    if (m_inputs.contains(in)) return true;
+    m_inputs.append(in);
+
+    // saída fechada: open() abre as duas e já registra a entrada
+    if (!m_sink) {
+        if (open() && m_inIo) return true;
+        m_inputs.removeAll(in);
+        if (m_sources.isEmpty()) close();
+        return false;
+    }
+
+    bool ok = true;
+    if (!m_inIo) {
+        const QAudioDevice inDev = QMediaDevices::defaultAudioInput();
+        runOnAudioThread([this, &inDev, &ok]{ ok = openInputDevice(inDev); });   // já inclui `in`
+    } else {
+        in->prepare(m_inSampleRate);
+        post(Command::AddInput, nullptr, in);
+    }
+    if (!ok) {
+        m_inputs.removeAll(in);
+        qWarning() << "[AudioEngine] microfone indisponivel";
+    }
+    return ok;
+}
+
+void AudioEngine::removeInput(AudioInput* in)
+{
+    if (!m_inputs.removeAll(in)) return;
+    if (m_sink) {
+        if (m_inputs.isEmpty()) {
+            runOnAudioThread([this]{ closeInputDevice(); });   // para de chamar capture()
+        } else {
+            post(Command::RemoveInput, nullptr, in);
+            waitApplied();
+        }
+    }
+    if (m_sources.isEmpty() && m_inputs.isEmpty()) close();
+}
+
+void AudioEngine::applyCommands()
+{
+    Command c;
+    while (m_cmds.pop(c)) applyCommand(c);
+}
+
+void AudioEngine::applyCommand(const Command& c)
+{
+    switch (c.type) {
+    case Command::Add:
+        if (m_activeCount < kMaxSources) m_active[m_activeCount++] = c.src;
+        break;
+    case Command::Remove:
+        for (int i = 0; i < m_activeCount; ++i) {
+            if (m_active[i] != c.src) continue;
+            m_active[i] = m_active[--m_activeCount];
+            break;
+        }
+        break;
+    case Command::AddInput:
+        if (m_activeInCount < kMaxInputs) m_activeIn[m_activeInCount++] = c.in;
+        break;
+    case Command::RemoveInput:
+        for (int i = 0; i < m_activeInCount; ++i) {
+            if (m_activeIn[i] != c.in) continue;
+            m_activeIn[i] = m_activeIn[--m_activeInCount];
+            break;
+        }
+        break;
+    }
+    m_applied.store(c.seq, std::memory_order_release);
+}
+
+// ---------------- callback ----------------
+void AudioEngine::mixBlock(float* mix, int frames)
+{
+    for (int i = 0; i < frames; ++i) mix[i] = 0.0f;
+    const qint64 clock = m_clock.load(std::memory_order_relaxed);
+    for (int s = 0; s < m_activeCount; ++s)
+        m_active[s]->render(mix, frames, clock);
+
+    // limitador de pico no master: ataque instantâneo, release ~50 ms
+    bool limited = false;
+    int  loud = -1;
+    float env = m_limEnv;
+    for (int i = 0; i < frames; ++i) {
+        const float a = std::abs(mix[i]);
+        if (a > 1.0e-5f) loud = i;
+        env = (a > env) ? a : env * m_limRel;
+        if (env > kLimitThreshold) {
+            mix[i] *= kLimitThreshold / env;
+            limited = true;
+        }
+    }
+    m_limEnv = env;
+    if (limited) m_statLimited.fetch_add(1, std::memory_order_relaxed);
+
+    // referência para a entrada rejeitar o próprio som (só com microfone;
+    // depois de um histórico inteiro de silêncio ninguém mais a consulta)
+    if (loud >= 0) m_lastLoud = clock + loud;
+    if (m_activeInCount > 0 && m_lastLoud > clock - kRefFrames) {
+        for (int i = 0; i < frames; ++i)
+            m_ref[(clock + i) & (kRefFrames - 1)] = mix[i];
+    }
+    m_clock.store(clock + frames, std::memory_order_release);
+}
+
+qint64 AudioEngine::readBlock(char* data, qint64 maxlen)
+{
+    applyCommands();
+
+    const int ch  = qMax(1, m_fmt.channelCount());
+    const int bps = qMax(1, m_fmt.bytesPerSample());
+    const QAudioFormat::SampleFormat sf = m_fmt.sampleFormat();
+    const int total = int(maxlen / (ch * bps));
+
+    char* out = data;
+    for (int done = 0; done < total; ) {
+        const int n = qMin(kBlock, total - done);
+        mixBlock(m_mix, n);
+        // mono -> formato/canais da sink
+        for (int i = 0; i < n; ++i) {
+            const float v = m_mix[i];
+            for (int c = 0; c < ch; ++c, out += bps) {
+                switch (sf) {
+                case QAudioFormat::Float:
+                    *reinterpret_cast<float*>(out) = v; break;
+                case QAudioFormat::Int32:
+                    *reinterpret_cast<qint32*>(out) = qint32(qBound(-1.0f, v, 1.0f) * 2147483520.0f); break;
+                case QAudioFormat::UInt8:
+                    *reinterpret_cast<quint8*>(out) = quint8(128 + int(qBound(-1.0f, v, 1.0f) * 127.0f)); break;
+                default:
+                    *reinterpret_cast<qint16*>(out) = qint16(qBound(-1.0f, v, 1.0f) * 32767.0f); break;
+                }
+            }
+        }
+        done += n;
+    }
+
+    const qint64 bytes = out - data;
+    m_statCallbacks.fetch_add(1, std::memory_order_relaxed);
+    m_statFrames.fetch_add(quint64(total), std::memory_order_relaxed);
+    if (bytes < maxlen) m_statShort.fetch_add(1, std::memory_order_relaxed);
+    return bytes;
+}
+
+// ---------------- estatísticas ----------------
+AudioEngine::Stats AudioEngine::stats() const
+{
+    Stats st;
+    st.callbacks        = m_statCallbacks.load(std::memory_order_relaxed);
+    st.frames           = m_statFrames.load(std::memory_order_relaxed);
+    st.lateCallbacks    = m_statLate.load(std::memory_order_relaxed);
+    st.shortReads       = m_statShort.load(std::memory_order_relaxed);
+    st.limited          = m_statLimited.load(std::memory_order_relaxed);
+    st.maxCallbackGapMs = m_statMaxGapUs.load(std::memory_order_relaxed) / 1000.0;
+    st.inputFrames      = m_statInFrames.load(std::memory_order_relaxed);
+    st.inputOffset      = m_statInOffset.load(std::memory_order_relaxed);
+    return st;
+}
+
+void AudioEngine::resetStats()
+{
+    m_statCallbacks = 0; m_statFrames = 0; m_statLate = 0;
+    m_statShort = 0; m_statLimited = 0; m_statMaxGapUs = 0;
+    m_statInFrames = 0;
+}
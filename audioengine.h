@@ -0,0 +1,215 @@
+#pragma once
+#include <QObject>
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "spscqueue.h"
+
+class QAudioDevice;
+class QAudioSink;
+class QAudioSource;
+class QIODevice;
+class QThread;
+
+// Fonte mixada pelo AudioEngine (voz de tom, camadas de click, players...).
+// render() roda no callback de áudio: SOMA frames samples mono em [-1, 1]
+// ao bloco, a partir do sample `clock` do relógio comum; não pode alocar
+// nem bloquear.
+class AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+    virtual void prepare(int sampleRate) = 0;   // GUI, com a fonte fora do mix
+    virtual void render(float* mix, int frames, qint64 clock) = 0;
+};
+
+// O que o próprio app tocou nos mesmos samples de um bloco de entrada:
+// o mix final (para cancelar eco) e os inícios de transientes marcados
+// pelas fontes (clicks). Campos nulos = nada daquele tipo no bloco.
+struct AudioRef
+{
+    const float*  signal    = nullptr;
+    const quint8* transient = nullptr;   // 1 no frame em que um click começa
+};
+
+// Consumidor da entrada (afinador, medição de latência...). capture() roda
+// na thread de áudio com frames mono em [-1, 1]; `clock` é o sample do
+// relógio comum da saída que corresponde ao 1º frame e `ref` é nulo quando
+// a saída estava em silêncio. Mesmas regras de render(): sem alocar nem
+// bloquear.
+class AudioInput
+{
+public:
+    virtual ~AudioInput() = default;
+    virtual void prepare(int sampleRate) = 0;   // taxa do microfone
+    virtual void capture(const float* in, int frames, qint64 clock, const AudioRef* ref) = 0;
+};
+
+// Áudio único do app (duplex): uma QAudioSink (pull mode) no device
+// padrão, fila de comandos sem lock para entrar/sair do mix, mix em float
+// por callback com limitador no master e um relógio de samples comum a
+// todas as fontes (drone e metrônomo ficam alinhados no mesmo stream).
+// Com consumidores de entrada, o microfone abre junto com a saída e cada
+// frame capturado é carimbado no mesmo relógio.
+//
+// A sink vive numa thread própria (TimeCriticalPriority): pintura e layout
+// na GUI não atrasam o callback. A GUI só fala com ela pela fila de
+// comandos e pelos atômicos das fontes; open/close/removeSource esperam a
+// thread de áudio, mas nunca dentro do callback.
+class AudioEngine : public QObject
+{
+    Q_OBJECT
+public:
+    static AudioEngine& shared();
+
+    bool open();                          // cria/inicia a sink; false sem device
+    void close();
+    void shutdown();                      // fecha e encerra a thread de áudio
+    bool isOpen() const { return m_sink != nullptr; }
+
+    void setLatencyTargetMs(int ms);      // 10..200, default 30; recria a sink
+    int  latencyTargetMs() const { return m_latencyMs; }
+    int  sampleRate() const      { return m_sampleRate; }
+
+    // addSource chama prepare() e a fonte entra no próximo bloco;
+    // removeSource só volta quando o callback não usa mais a fonte.
+    // Sem fontes, a sink é fechada.
+    void addSource(AudioSource* src);
+    void removeSource(AudioSource* src);
+    bool hasSource(AudioSource* src) const { return m_sources.contains(src); }
+
+    // Entrada: addInput abre saída + microfone (a saída roda em silêncio se
+    // não houver fontes); false sem microfone/permissão. removeInput só
+    // volta quando o callback não usa mais o consumidor.
+    bool addInput(AudioInput* in);
+    void removeInput(AudioInput* in);
+    bool hasInput(AudioInput* in) const { return m_inputs.contains(in); }
+    int  inputSampleRate() const { return m_inSampleRate; }
+
+    // Só de dentro de AudioSource::render(): um transiente (click) começa
+    // no sample `clock`; a entrada recebe a marca no AudioRef.
+    void markTransient(qint64 clock) { m_trans[m_transHead++ & (kTransients - 1)] = clock; }
+
+    // relógio comum: frames mixados desde open()
+    qint64 sampleClock() const { return m_clock.load(std::memory_order_acquire); }
+    qint64 queuedFrames() const { return qMax<qint64>(0, sampleClock() - playedFrames()); }
+    qint64 playedFrames() const;          // já saíram do device (interpolado entre callbacks)
+    // consumidos pelo backend segundo QAudioSink::processedUSecs(), lido a
+    // cada callback: sem interpolação, atrasa no máximo um período
+    qint64 deviceFrames() const { return m_deviceFrames.load(std::memory_order_acquire); }
+
+    struct Stats {
+        quint64 callbacks     = 0;        // readData() pedidos pela sink
+        quint64 frames        = 0;
+        // intervalo entre callbacks > buffer da sink: o device ficou sem
+        // dados (em pull mode readData sempre completa o pedido, então a
+        // sink nunca reporta UnderrunError; a falta aparece aqui)
+        quint64 lateCallbacks = 0;
+        quint64 shortReads    = 0;        // devolveu menos que o pedido
+        quint64 limited       = 0;        // blocos em que o limitador atuou
+        double  maxCallbackGapMs = 0.0;
+        quint64 inputFrames   = 0;        // capturados e entregues
+        double  inputOffset   = 0.0;      // relógio da saída - frame de entrada
+    };
+    Stats stats() const;
+    void  resetStats();
+
+private:
+    explicit AudioEngine(QObject* parent = nullptr);
+    ~AudioEngine() override;
+
+    class Stream;
+    friend class Stream;
+
+    struct Command {
+        enum Type : quint8 { Add, Remove, AddInput, RemoveInput } type = Add;
+        AudioSource* src = nullptr;
+        AudioInput*  in  = nullptr;
+        quint64 seq = 0;
+    };
+    static constexpr int kMaxSources = 8;
+    static constexpr int kMaxInputs  = 4;
+    static constexpr int kRefFrames  = 1 << 15;   // histórico do mix (~0,7 s a 48 kHz)
+    static constexpr int kTransients = 32;
+    static constexpr int kBlock      = 512;   // frames mixados por passada
+
+    qint64 readBlock(char* data, qint64 maxlen);   // callback
+    void   applyCommands();                        // thread de áudio
+    void   applyCommand(const Command& c);         // thread de áudio
+    void   mixBlock(float* mix, int frames);
+    void   markPlayed(qint64 queuedFrames);        // callback
+    void   post(Command::Type type, AudioSource* src, AudioInput* in = nullptr);
+    void   waitApplied();
+    bool   openInputDevice(const QAudioDevice& dev);   // thread de áudio
+    void   closeInputDevice();                     // thread de áudio
+    void   readInput();                            // callback da entrada
+    const AudioRef* outputRef(qint64 clock, int frames);   // callback da entrada
+    void   runOnAudioThread(const std::function<void()>& fn);   // bloqueia a GUI
+
+    // thread de áudio (sink e stream vivem lá; a GUI só lê m_sink/m_fmt
+    // depois de um runOnAudioThread)
+    QThread*     m_thread = nullptr;
+    QObject*     m_ctx    = nullptr;          // contexto de execução na thread
+    QAudioSink*  m_sink   = nullptr;
+    Stream*      m_stream = nullptr;
+    QAudioFormat m_fmt;
+    QElapsedTimer m_wall;                    // base de tempo comum às duas threads
+    QAudioSource* m_inSource = nullptr;
+    QIODevice*   m_inIo   = nullptr;
+    QAudioFormat m_inFmt;
+    QByteArray   m_inRaw;                    // bloco lido do microfone
+
+    // GUI
+    double       m_bufferMs   = 0.0;          // duração do buffer da sink aberta
+    int          m_sampleRate = 44100;
+    int          m_latencyMs  = 30;
+    QVector<AudioSource*> m_sources;
+    QVector<AudioInput*>  m_inputs;
+    int          m_inSampleRate = 0;
+    quint64      m_posted = 0;
+
+    // GUI -> callback
+    SpscQueue<Command, 32> m_cmds;
+    std::atomic<quint64>   m_applied {0};
+
+    // callback
+    AudioSource* m_active[kMaxSources] = {};
+    int          m_activeCount = 0;
+    float        m_mix[kBlock];
+    float        m_limEnv  = 0.0f;        // envelope de pico do limitador
+    float        m_limRel  = 0.999f;      // release por sample (~50 ms)
+    AudioInput*  m_activeIn[kMaxInputs] = {};
+    int          m_activeInCount = 0;
+    float        m_inMix[kBlock];
+    qint64       m_inTotal  = 0;          // frames lidos desde a abertura
+    double       m_inRatio  = 1.0;        // taxa da saída / taxa da entrada
+    double       m_inOffset = 0.0;        // relógio da saída - m_inTotal * ratio
+    bool         m_inLocked = false;
+    float        m_ref[kRefFrames];       // mix final indexado pelo relógio
+    qint64       m_lastLoud = -1;         // último sample não silencioso do mix
+    qint64       m_trans[kTransients] = {};
+    unsigned     m_transHead = 0;
+    float        m_refOut[kBlock];
+    quint8       m_transOut[kBlock];
+    AudioRef     m_refView;
+
+    // callback -> GUI
+    std::atomic<qint64>  m_clock {0};
+    // âncora do relógio de saída: em m_playedNs o device já tinha tocado
+    // m_playedAt frames (seqlock: ímpar = escrita em curso)
+    std::atomic<quint32> m_playSeq {0};
+    std::atomic<qint64>  m_playedAt {0};
+    std::atomic<qint64>  m_playedNs {0};
+    std::atomic<qint64>  m_deviceFrames {0};
+    std::atomic<quint64> m_statCallbacks {0};
+    std::atomic<quint64> m_statFrames {0};
+    std::atomic<quint64> m_statLate {0};
+    std::atomic<quint64> m_statShort {0};
+    std::atomic<quint64> m_statLimited {0};
+    std::atomic<qint64>  m_statMaxGapUs {0};
+    std::atomic<quint64> m_statInFrames {0};
+    std::atomic<double>  m_statInOffset {0.0};
+};
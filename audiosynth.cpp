@@ -0,0 +1,51 @@
+#include "audiosynth.h"
+
+QVector<qint16> genClick(int sr, double hz, int ms, float amp)
+{
+    const int N = qMax(1, (sr * ms) / 1000);
+    QVector<qint16> out;
+    out.resize(N);
+    const double w = 2.0 * M_PI * hz / double(sr);
+
+    // janela curta (fade in/out) para evitar estalos
+    const int fade = qMax(1, sr / 1000 * 2); // ~2 ms
+    for (int i=0; i<N; ++i) {
+        double env = 1.0;
+        if (i < fade) env = double(i) / fade;
+        else if (i > N - 1 - fade) env = double(N - 1 - i) / fade;
+
+        double s = amp * env * std::sin(w * i);
+        s = qBound(-1.0, s, 1.0);
+        out[i] = qint16(s * 32767.0);
+    }
+    return out;
+}
+
+QVector<float> resample(const QVector<float>& in, int inRate, int outRate)
+{
+    if (inRate <= 0 || outRate <= 0 || inRate == outRate || in.isEmpty()) return in;
+
+    const double ratio = double(outRate) / inRate;
+    const double fc    = qMin(1.0, ratio) * 0.95;   // corte abaixo do menor Nyquist
+    const int    taps  = 24;                        // meia janela, em zeros do sinc
+    const double half  = taps / fc;                 // meia janela em samples de entrada
+
+    const int n = int(std::ceil(in.size() * ratio));
+    QVector<float> out(n);
+    for (int i = 0; i < n; ++i) {
+        const double t  = i / ratio;                // posição na entrada
+        const int    j0 = qMax(0, int(std::ceil(t - half)));
+        const int    j1 = qMin(int(in.size()) - 1, int(std::floor(t + half)));
+        double acc = 0.0;
+        for (int j = j0; j <= j1; ++j) {
+            const double x = t - j;
+            const double u = M_PI * fc * x;
+            const double sinc = (std::abs(u) < 1e-9) ? 1.0 : std::sin(u) / u;
+            const double w = 0.42 + 0.5 * std::cos(M_PI * x / half)
+                           + 0.08 * std::cos(2.0 * M_PI * x / half);
+            acc += in[j] * fc * sinc * w;
+        }
+        out[i] = float(acc);
+    }
+    return out;
+}
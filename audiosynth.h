@@ -0,0 +1,56 @@
+#pragma once
+#include <QVector>
+#include <QtGlobal>
+#include <QtMath>
+
+// Núcleo de síntese compartilhado entre o áudio ao vivo (ToneGenerator,
+// MetronomeWidget) e o render offline (tools/musicool-render).
+// Só depende de QtCore: nada de device, sink ou widget aqui.
+
+// Oscilador senoidal com rampa linear de amplitude (~5 ms), fase contínua
+class SineVoice
+{
+public:
+    void setSampleRate(int sr) {
+        m_sr = qMax(8000, sr);
+        m_rampSamples = qMax(1, m_sr / 200); // ~5ms
+    }
+    int sampleRate() const { return m_sr; }
+
+    void  setTargetAmp(float a) { m_targetAmp = qBound(0.0f, a, 1.0f); }
+    float targetAmp() const     { return m_targetAmp; }
+    float amp() const           { return m_amp; }
+
+    // Um sample em [-1, 1] na frequência hz (pode mudar a cada sample)
+    inline double next(double hz) {
+        if (m_amp < m_targetAmp) {
+            m_amp = qMin(m_targetAmp, m_amp + (1.0f / m_rampSamples));
+        } else if (m_amp > m_targetAmp) {
+            m_amp = qMax(m_targetAmp, m_amp - (1.0f / m_rampSamples));
+        }
+
+        const double twoPi = 2.0 * M_PI;
+        const double s = std::sin(m_phase) * double(m_amp);
+        m_phase += twoPi * hz / double(m_sr);
+        if (m_phase >= twoPi) m_phase -= twoPi;
+        return s;
+    }
+
+    static inline qint16 toInt16(double s) {
+        return qint16(int(qBound(-1.0, s, 1.0) * 32767.0));
+    }
+
+private:
+    int    m_sr = 44100;
+    int    m_rampSamples = 220;   // ~5ms @44.1k
+    float  m_amp = 0.0f;
+    float  m_targetAmp = 0.0f;
+    double m_phase = 0.0;
+};
+
+// Click curto (burst senoidal com fade de ~2 ms) usado pelo metrônomo
+QVector<qint16> genClick(int sr, double hz, int ms, float amp = 0.9f);
+
+// Reamostragem (sinc janelado, Blackman) para amostras curtas: cara, feita
+// uma vez ao carregar sons, nunca no callback de áudio
+QVector<float> resample(const QVector<float>& in, int inRate, int outRate);
@@ -0,0 +1,72 @@
+#include "clickbank.h"
+#include "audiosynth.h"
+#include "wavfile.h"
+
+#include <QDebug>
+#include <QDir>
+
+static const char* kSoundDir = ":/sounds";
+
+QStringList ClickBank::names()
+{
+    QStringList out;
+    const QStringList files = QDir(kSoundDir).entryList({"*_hi.wav"}, QDir::Files, QDir::Name);
+    for (const QString& f : files) out << f.left(f.size() - int(qstrlen("_hi.wav")));
+    return out;
+}
+
+int ClickBank::indexOf(const QString& name) const
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+        if (m_entries.at(i).name == name) return i;
+    return -1;
+}
+
+static QVector<float> loadAt(const QString& path, int sampleRate)
+{
+    WavReader wav;
+    if (!wav.load(path)) {
+        qWarning() << "[ClickBank]" << path << wav.errorString();
+        return {};
+    }
+    return resample(wav.mono(), wav.sampleRate(), sampleRate);
+}
+
+bool ClickBank::load(int sampleRate)
+{
+    if (sampleRate == m_rate) return true;
+
+    QVector<qint16> pool;
+    QVector<Entry>  entries;
+    for (const QString& name : names()) {
+        const QVector<float> hi = loadAt(QString("%1/%2_hi.wav").arg(kSoundDir, name), sampleRate);
+        const QVector<float> lo = loadAt(QString("%1/%2_lo.wav").arg(kSoundDir, name), sampleRate);
+        if (hi.isEmpty() || lo.isEmpty()) continue;
+
+        // acento, normal e subdivisão já no formato do stream (16-bit)
+        Entry e;
+        e.name = name;
+        const QVector<float>* src[3] = {&hi, &lo, &lo};
+        const float gain[3] = {1.0f, 1.0f, 0.5f};
+        for (int c = 0; c < 3; ++c) {
+            e.off[c] = int(pool.size());
+            e.len[c] = int(src[c]->size());
+            for (float v : *src[c]) pool.append(SineVoice::toInt16(v * gain[c]));
+        }
+        entries.append(e);
+    }
+
+    m_pool    = pool;
+    m_entries = entries;
+    m_rate    = entries.isEmpty() ? 0 : sampleRate;
+    qInfo() << "[ClickBank]" << m_entries.size() << "sons @" << sampleRate
+            << "Hz," << poolBytes() / 1024 << "KiB";
+    return isLoaded();
+}
+
+QVector<qint16> ClickBank::slice(int sound, int clip) const
+{
+    if (sound < 0 || sound >= m_entries.size()) return {};
+    const Entry& e = m_entries.at(sound);
+    return m_pool.mid(e.off[clip], e.len[clip]);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+
+// Banco de sons de click do metrônomo (stuff.qrc: sounds/<nome>_hi.wav para
+// o acento e sounds/<nome>_lo.wav para os demais tempos).
+//
+// load() decodifica todos os WAVs, reamostra para a taxa real da sink e
+// converte para 16-bit uma única vez, num pool contíguo. Trocar de som só
+// copia um trecho do pool para o engine; o callback nunca decodifica nem
+// reamostra nada.
+class ClickBank
+{
+public:
+    static QStringList names();          // sons disponíveis nos recursos
+
+    bool load(int sampleRate);           // não faz nada se já carregado nessa taxa
+    bool isLoaded() const   { return m_rate > 0; }
+    int  sampleRate() const { return m_rate; }
+    int  indexOf(const QString& name) const;
+
+    // clips prontos para MetronomeEngine::setClicks (subdivisão = _lo a -6 dB)
+    QVector<qint16> accent(int sound) const      { return slice(sound, 0); }
+    QVector<qint16> normal(int sound) const      { return slice(sound, 1); }
+    QVector<qint16> subdivision(int sound) const { return slice(sound, 2); }
+
+    qsizetype poolBytes() const { return m_pool.size() * qsizetype(sizeof(qint16)); }
+
+private:
+    struct Entry {
+        QString name;
+        int off[3] = {};
+        int len[3] = {};
+    };
+    QVector<qint16> slice(int sound, int clip) const;
+
+    QVector<qint16> m_pool;
+    QVector<Entry>  m_entries;
+    int             m_rate = 0;
+};
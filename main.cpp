@@ -1,14 +1,43 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QTimer>
+#include <QDebug>
 
 #ifdef Q_OS_ANDROID
 #include <QtCore/qnativeinterface.h>
 #include <QtCore/QJniObject>
 #endif
 
+// Cold start: do início do main() até a primeira pintura da janela. O log
+// sai no próximo giro do loop, depois que o paint já foi para a tela.
+class FirstPaintProbe : public QObject
+{
+public:
+    explicit FirstPaintProbe(const QElapsedTimer& clock) : m_clock(clock) {}
+
+protected:
+    bool eventFilter(QObject* obj, QEvent* e) override {
+        if (e->type() == QEvent::Paint) {
+            obj->removeEventFilter(this);
+            QTimer::singleShot(0, obj, [this]{
+                qInfo() << "[Startup] main -> primeira pintura:" << m_clock.elapsed() << "ms";
+                deleteLater();
+            });
+        }
+        return false;
+    }
+
+private:
+    const QElapsedTimer& m_clock;
+};
 
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startup;
+    startup.start();
+
     QApplication a(argc, argv);
 
 #ifdef Q_OS_ANDROID
@@ -30,6 +59,10 @@ int main(int argc, char *argv[])
 #endif
 
     MainWindow w;
+    if (MainWindow::startupLogEnabled()) {
+        qInfo() << "[Startup] main -> MainWindow construída:" << startup.elapsed() << "ms";
+        w.installEventFilter(new FirstPaintProbe(startup));
+    }
     w.show();
 
 #ifdef Q_OS_ANDROID
@@ -3,6 +3,9 @@
 
 #include "tunerwidget.h"
 #include "pitchtracker.h"
+#include "notescrollwidget.h"
+#include "pitchhistorywidget.h"
+#include "spectrumwidget.h"
 
 #include <QVBoxLayout>
 #include <QTimer>
@@ -10,12 +13,18 @@
 #include <QFrame>
 #include <QGuiApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QEvent>
 #include <QStyle>
 #include <QStyleOption>
 #include <QStyleOptionSlider>
 #include <QProxyStyle>
 #include <QScroller>
+#include <QComboBox>
+#include <QHBoxLayout>
+#include <QPoint>
+#include <QSignalBlocker>
+#include <cmath>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -58,10 +67,17 @@ Ao sair da aba Tuner, o microfone será desligado automaticamente.</p>
 <p>Esse é um gerador de frequência, para afinar em qualquer nota desejada.
 É possível também usar bemol e sustenido, trocar de nota ou de oitava,
 através dos botões.<br>
-Play e Stop levam até 2 segundos para iniciar.</p>
+O áudio é preparado ao abrir esta aba, então Play e Stop respondem na hora.</p>
 
 <h2>Metronome</h2>
-<p>O metrônomo tem seleção de compasso binário, ternário e quaternário.
+<p>O metrônomo tem atalhos para compasso binário, ternário e quaternário
+e uma lista com outros compassos (5/4, 6/8, 9/8, 12/8). Também é possível
+subdividir o tempo (colcheias, tercinas, semicolcheias) e, com colcheias ou
+semicolcheias, aplicar swing.
+No treino de andamento o BPM sobe sozinho (em rampa ou em degraus) ou o
+metrônomo alterna compassos tocando e em silêncio.
+A polirritmia soma camadas com 3 e/ou 5 pulsos por compasso, em outro timbre
+(em 2/4, a camada de 3 dá o 3 contra 2).
 O ajuste de BPM permite adicionar 1 unidade de tempo ou 10 unidades de tempo por vez.</p>
 
 <h2>Sobre o autor</h2>
@@ -73,76 +89,66 @@ responsabilidade do autor.</p>
 <p>Que a Paz de Deus esteja em vossos lares. (Amém.)</p>
 )");
 
-    // ===== METRONOME =====
-    ui->lineEdit_metronome->setReadOnly(true);
-    this->metro = new MetronomeWidget(this);
-    metro->setBeatsPerMeasure(4);
-    metro->setBpm(ui->lineEdit_metronome->text().toInt());
-    metro->setAudioEnabled(true);
-    metro->setAccentEnabled(true);
-
-    if (auto *lay = qobject_cast<QVBoxLayout*>(ui->frameMetro->layout())) {
-        lay->addWidget(metro);
-    } else {
-        auto *lay2 = new QVBoxLayout(ui->frameMetro);
-        lay2->setContentsMargins(0,0,0,0);
-        lay2->addWidget(metro);
-    }
-
-    m_group = new QButtonGroup(this);
-    b_group = new QButtonGroup(this);
-
-    m_group->addButton(ui->pushButton_2);
-    m_group->addButton(ui->pushButton_3);
-    m_group->addButton(ui->pushButton_4);
-
-    m_group->setId(ui->pushButton_2,2);
-    m_group->setId(ui->pushButton_3,3);
-    m_group->setId(ui->pushButton_4,4);
-    m_group->setExclusive(true);
-
-    ui->pushButton_2->setCheckable(true);
-    ui->pushButton_3->setCheckable(true);
-    ui->pushButton_4->setCheckable(true);
-    ui->pushButton_4->setChecked(true);
+    // ===== PÁGINAS =====
+    // afinador, gerador e metrônomo só são montados (widgets, áudio, ligações)
+    // na primeira vez que a aba abre; até lá ficam os frames vazios do .ui
+    setupToolBoxBehavior();
 
-    connect(m_group, &QButtonGroup::idClicked, this, [this](int beats){
-        metro->setBeatsPerMeasure(beats);
+    QTimer::singleShot(0, this, [this]{
+        if (ui->toolBox->currentIndex() == TUNER)
+            startTunerWithPermission();
     });
 
-    b_group->addButton(ui->pushButton_less_one);
-    b_group->addButton(ui->pushButton_less_10);
-    b_group->addButton(ui->pushButton_plus_one);
-    b_group->addButton(ui->pushButton_plus_ten);
+    connect(qApp, &QGuiApplication::applicationStateChanged,
+            this, [this](Qt::ApplicationState st){
+                if (st == Qt::ApplicationActive && ui->toolBox->currentIndex() == TUNER)
+                    startTunerWithPermission();
+            });
 
-    b_group->setId(ui->pushButton_less_one,-1);
-    b_group->setId(ui->pushButton_less_10,-10);
-    b_group->setId(ui->pushButton_plus_one,1);
-    b_group->setId(ui->pushButton_plus_ten,10);
+    // ===== DEFAULT TAB =====
+    ui->toolBox->setCurrentIndex(PAGEINFO);
+    ensurePage(ui->toolBox->currentIndex());
+}
 
-    connect(ui->pushButton_start, &QPushButton::clicked, metro, &MetronomeWidget::start);
-    connect(ui->pushButton_stop,  &QPushButton::clicked, metro, &MetronomeWidget::stop);
+void MainWindow::ensurePage(int idx)
+{
+    switch (idx) {
+    case TUNER:     ensureTunerPage();     break;
+    case GENFREQ:   ensureToneGenPage();   break;
+    case METRONOME: ensureMetronomePage(); break;
+    default: break;
+    }
+}
+
+void MainWindow::ensureTunerPage()
+{
+    if (m_tracker) return;
+    QElapsedTimer t;
+    t.start();
 
-    // ===== TUNER =====
     m_tuner   = new TunerWidget(this);
     m_tracker = new PitchTracker(this);
+    m_pitchHistory = new PitchHistoryWidget(this);
+    m_noteScroll = new NoteScrollWidget(this);
+    m_spectrumView = new SpectrumWidget(this);
 
     setupTunerInFrame();
     wireTunerSignals();
-    setupToolBoxBehavior();
 
-    QTimer::singleShot(0, this, [this]{
-        if (ui->toolBox->currentIndex() == TUNER)
-            startTunerWithPermission();
-    });
+    // gerador já soando antes do afinador existir: rejeita o drone desde já
+    if (toneGen && toneGen->isPlaying())
+        m_tracker->setRejectFrequencies({toneGen->frequency()});
 
-    connect(qApp, &QGuiApplication::applicationStateChanged,
-            this, [this](Qt::ApplicationState st){
-                if (st == Qt::ApplicationActive && ui->toolBox->currentIndex() == TUNER)
-                    startTunerWithPermission();
-            });
+    if (startupLogEnabled())
+        qInfo() << "[Startup] página afinador montada em" << t.elapsed() << "ms";
+}
+
+void MainWindow::ensureToneGenPage()
+{
+    if (toneGen) return;
+    QElapsedTimer t;
+    t.start();
 
-    // ===== NOTES SOUND =====
     this->toneGen = new ToneGenerator(this);
 
     ui->pushButton_octave_down->setIcon(style()->standardIcon(QStyle::SP_ArrowDown));
@@ -209,7 +215,29 @@ responsabilidade do autor.</p>
         qDebug() << "[Tone] hz =" << hz;
     });
 
-    // ===== STAFF =====
+    // afinador ignora o drone do próprio app (notch só enquanto ele soa)
+    auto rejectDrone = [this](double hz){
+        if (m_tracker)   // afinador ainda não aberto: nada a rejeitar
+            m_tracker->setRejectFrequencies(hz > 0.0 ? QVector<double>{hz} : QVector<double>{});
+    };
+    connect(toneGen, &ToneGenerator::started, this, [=]{ rejectDrone(toneGen->frequency()); });
+    connect(toneGen, &ToneGenerator::stopped, this, [=]{ rejectDrone(0.0); });
+    connect(toneGen, &ToneGenerator::frequencyChanged, this, [=](double hz){
+        if (toneGen->isPlaying()) rejectDrone(hz);
+    });
+    connect(toneGen, &ToneGenerator::sequenceStepChanged, this, [=](int, int midi){
+        rejectDrone(midi >= 0 ? 440.0 * std::pow(2.0, (midi - 69) / 12.0) : 0.0);
+    });
+    connect(toneGen, &ToneGenerator::sequenceFinished, this, [=]{ rejectDrone(0.0); });
+
+    // drone/sequência parou com outra aba aberta: o gerador sai do mix.
+    // Enfileirado para não remover a fonte de dentro do próprio stop()
+    connect(toneGen, &ToneGenerator::stopped, this, &MainWindow::releaseIdleAudio,
+            Qt::QueuedConnection);
+    connect(toneGen, &ToneGenerator::sequenceFinished, this, &MainWindow::releaseIdleAudio,
+            Qt::QueuedConnection);
+
+    // pauta
     this->staff = new StaffNoteWidget(this);
     staff->setPreferAccidentals(StaffNoteWidget::AccPref::Sharps);
     staff->setShowLabel(true);
@@ -219,12 +247,189 @@ responsabilidade do autor.</p>
         if (staff) staff->setFrequency(hz, StaffNoteWidget::AccPref::Sharps);
     });
 
+    // exercícios do sequenciador: a pauta acompanha o passo que está soando
+    connect(toneGen, &ToneGenerator::sequenceStepChanged, this, [this](int, int midi){
+        if (staff && midi >= 0) staff->setMidi(midi, StaffNoteWidget::AccPref::Sharps);
+    });
+
     this->staff->setColors(QColor("#121212"), QColor("#3C3C40"),
                            QColor("#FAFAFA"), QColor("#4F8AFF"), QColor("#E0E0E0"));
     this->setupStaffInFrame();
 
-    // ===== DEFAULT TAB =====
-    ui->toolBox->setCurrentIndex(PAGEINFO);
+    if (startupLogEnabled())
+        qInfo() << "[Startup] página gerador montada em" << t.elapsed() << "ms";
+}
+
+void MainWindow::ensureMetronomePage()
+{
+    if (metro) return;
+    QElapsedTimer t;
+    t.start();
+
+    ui->lineEdit_metronome->setReadOnly(true);
+    this->metro = new MetronomeWidget(this);
+    metro->setBeatsPerMeasure(4);
+    metro->setBpm(ui->lineEdit_metronome->text().toInt());
+    metro->setAudioEnabled(true);
+    metro->setAccentEnabled(true);
+
+    // som do click: senoide ou um dos sons do banco (stuff.qrc)
+    auto *sound = new QComboBox(this);
+    sound->addItem("Senoidal", QString());
+    for (const QString& name : ClickBank::names())
+        sound->addItem(name.left(1).toUpper() + name.mid(1), name);
+    connect(sound, &QComboBox::currentIndexChanged, this, [this, sound](int i){
+        metro->setClickSound(sound->itemData(i).toString());
+    });
+
+    // compasso, subdivisão e swing; os botões 2/3/4 são atalhos para x/4
+    auto *meter = new QComboBox(this);
+    for (const QPoint& ts : {QPoint(2, 4), QPoint(3, 4), QPoint(4, 4), QPoint(5, 4),
+                             QPoint(6, 8), QPoint(9, 8), QPoint(12, 8)})
+        meter->addItem(QString("%1/%2").arg(ts.x()).arg(ts.y()), ts);
+    meter->setCurrentText("4/4");
+
+    auto *subdiv = new QComboBox(this);
+    subdiv->addItem("Sem subdivisão", 1);
+    subdiv->addItem("Colcheias", 2);
+    subdiv->addItem("Tercinas", 3);
+    subdiv->addItem("Semicolcheias", 4);
+
+    auto *swing = new QComboBox(this);
+    swing->addItem("Reto", 0.0);
+    swing->addItem("Swing leve", 0.5);
+    swing->addItem("Swing", 1.0);
+
+    // x/8 composto já vem com 3 colcheias por tempo; swing só com pulsos pares
+    auto syncPattern = [this, meter, subdiv, swing]{
+        const BeatPattern& p = metro->pattern();
+        const bool compound = meter->currentData().toPoint().y() == 8;
+        const QSignalBlocker b1(subdiv), b2(swing);
+        subdiv->setCurrentIndex(subdiv->findData(p.pulsesPerBeat));
+        subdiv->setEnabled(!compound);
+        swing->setEnabled(!compound && p.pulsesPerBeat % 2 == 0);
+        if (swing->isEnabled()) {
+            swing->setCurrentIndex(qMax(0, swing->findData(p.swing)));
+        } else {
+            swing->setCurrentIndex(0);
+            if (p.swing > 0.0) metro->setSwing(0.0);
+        }
+    };
+    connect(meter, &QComboBox::currentIndexChanged, this, [this, meter, syncPattern]{
+        const QPoint ts = meter->currentData().toPoint();
+        metro->setTimeSignature(ts.x(), ts.y());
+        // botões 2/3/4 acompanham; outro compasso deixa nenhum marcado
+        QAbstractButton* b = (ts.y() == 4) ? m_group->button(ts.x()) : nullptr;
+        if (b) {
+            b->setChecked(true);
+        } else if (m_group->checkedButton()) {
+            m_group->setExclusive(false);
+            m_group->checkedButton()->setChecked(false);
+            m_group->setExclusive(true);
+        }
+        syncPattern();
+    });
+    connect(subdiv, &QComboBox::currentIndexChanged, this, [this, subdiv, syncPattern]{
+        metro->setSubdivision(subdiv->currentData().toInt());
+        syncPattern();
+    });
+    connect(swing, &QComboBox::currentIndexChanged, this, [this, swing]{
+        metro->setSwing(swing->currentData().toDouble());
+    });
+    syncPattern();
+
+    // treino de andamento: parte do BPM escolhido
+    m_training = new QComboBox(this);
+    m_training->addItem("Sem treino");
+    m_training->addItem("Rampa +20 BPM em 16 compassos");
+    m_training->addItem("Degraus +2 BPM a cada 4 compassos");
+    m_training->addItem("Lacunas: 2 tocando, 2 em silêncio");
+    connect(m_training, &QComboBox::currentIndexChanged, this, &MainWindow::applyTraining);
+
+    // polirritmia: camadas extras com N pulsos no compasso (3 em 2/4 = 3:2)
+    auto *poly = new QComboBox(this);
+    poly->addItem("Sem polirritmia", QVariant::fromValue(QList<int>{}));
+    poly->addItem("Camada de 3 por compasso", QVariant::fromValue(QList<int>{3}));
+    poly->addItem("Camada de 5 por compasso", QVariant::fromValue(QList<int>{5}));
+    poly->addItem("Camadas de 3 e 5 por compasso", QVariant::fromValue(QList<int>{3, 5}));
+    connect(poly, &QComboBox::currentIndexChanged, this, [this, poly]{
+        metro->setPolyrhythm(poly->currentData().value<QList<int>>());
+    });
+
+    auto *patternRow = new QHBoxLayout;
+    patternRow->addWidget(meter);
+    patternRow->addWidget(subdiv);
+    patternRow->addWidget(swing);
+
+    auto *lay = qobject_cast<QVBoxLayout*>(ui->frameMetro->layout());
+    if (!lay) {
+        lay = new QVBoxLayout(ui->frameMetro);
+        lay->setContentsMargins(0,0,0,0);
+    }
+    lay->addWidget(metro);
+    lay->addWidget(sound);
+    lay->addLayout(patternRow);
+    lay->addWidget(m_training);
+    lay->addWidget(poly);
+
+    m_group = new QButtonGroup(this);
+    b_group = new QButtonGroup(this);
+
+    m_group->addButton(ui->pushButton_2);
+    m_group->addButton(ui->pushButton_3);
+    m_group->addButton(ui->pushButton_4);
+
+    m_group->setId(ui->pushButton_2,2);
+    m_group->setId(ui->pushButton_3,3);
+    m_group->setId(ui->pushButton_4,4);
+    m_group->setExclusive(true);
+
+    ui->pushButton_2->setCheckable(true);
+    ui->pushButton_3->setCheckable(true);
+    ui->pushButton_4->setCheckable(true);
+    ui->pushButton_4->setChecked(true);
+
+    connect(m_group, &QButtonGroup::idClicked, this, [this, meter, syncPattern](int beats){
+        metro->setBeatsPerMeasure(beats);
+        const QSignalBlocker block(meter);
+        meter->setCurrentText(QString("%1/4").arg(beats));
+        syncPattern();
+    });
+
+    b_group->addButton(ui->pushButton_less_one);
+    b_group->addButton(ui->pushButton_less_10);
+    b_group->addButton(ui->pushButton_plus_one);
+    b_group->addButton(ui->pushButton_plus_ten);
+
+    b_group->setId(ui->pushButton_less_one,-1);
+    b_group->setId(ui->pushButton_less_10,-10);
+    b_group->setId(ui->pushButton_plus_one,1);
+    b_group->setId(ui->pushButton_plus_ten,10);
+
+    // treino de andamento: o campo acompanha o BPM efetivo da rampa
+    connect(metro, &MetronomeWidget::tempoChanged, this, [this](double bpm){
+        ui->lineEdit_metronome->setText(QString::number(qRound(bpm)));
+    });
+
+    connect(ui->pushButton_start, &QPushButton::clicked, metro, &MetronomeWidget::start);
+    connect(ui->pushButton_stop,  &QPushButton::clicked, metro, &MetronomeWidget::stop);
+
+    if (startupLogEnabled())
+        qInfo() << "[Startup] página metrônomo montada em" << t.elapsed() << "ms";
+}
+
+void MainWindow::applyTraining()
+{
+    // rampas vão do BPM escolhido até +20; lacunas mantêm o andamento
+    const double bpm = metro->bpm();
+    const double top = qMin(bpm + 20.0, double(MAX_BPM));
+    switch (m_training->currentIndex()) {
+    case 1:  metro->setTempoRamp(TempoRamp::linear(bpm, top, 16));        break;
+    case 2:  metro->setTempoRamp(TempoRamp::stepped(bpm, top, 2.0, 4));   break;
+    case 3:  metro->setTempoRamp(TempoRamp::gaps(2, 2));                  break;
+    default: metro->clearTempoRamp();                                     break;
+    }
+    ui->lineEdit_metronome->setText(QString::number(qRound(metro->currentBpm())));
 }
 
 bool MainWindow::event(QEvent *e)
@@ -293,6 +498,7 @@ void MainWindow::setBPMvalue(QAbstractButton* button)
     int bpm = std::clamp(metro->bpm() + delta, MIN_BPM, MAX_BPM);
     metro->setBpm(bpm);
     ui->lineEdit_metronome->setText(QString::number(bpm));
+    if (m_training && m_training->currentIndex() > 0) applyTraining();   // rampa parte do novo BPM
 }
 
 MainWindow::~MainWindow()
@@ -301,6 +507,12 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+bool MainWindow::startupLogEnabled()
+{
+    static const bool on = qEnvironmentVariableIsSet("MUSICOOL_STARTUP_LOG");
+    return on;
+}
+
 void MainWindow::setupTunerInFrame()
 {
     QFrame* frame = ui->frameTuner;
@@ -315,9 +527,33 @@ void MainWindow::setupTunerInFrame()
     }
 
     if (m_tuner->parentWidget() != frame) {
-        lay->addWidget(m_tuner);
+        lay->addWidget(m_tuner, 3);
         m_tuner->show();
     }
+
+    // desvio ao longo do tempo (deriva/vibrato), logo abaixo do ponteiro
+    if (m_pitchHistory && m_pitchHistory->parentWidget() != frame) {
+        lay->addWidget(m_pitchHistory, 2);
+        m_pitchHistory->show();
+    }
+
+    // pauta rolante com o que foi tocado
+    if (m_noteScroll && m_noteScroll->parentWidget() != frame) {
+        m_noteScroll->setClefImage(QPixmap(":/sol.png"));
+        lay->addWidget(m_noteScroll, 2);
+        m_noteScroll->show();
+    }
+
+    // espectro + cascata: só aparece (e só custa a FFT) quando pedido
+    if (m_spectrumView && m_spectrumView->parentWidget() != frame) {
+        auto* toggle = new QPushButton(tr("Espectro"), frame);
+        toggle->setCheckable(true);
+        toggle->setFlat(true);
+        lay->addWidget(toggle, 0, Qt::AlignRight);
+        lay->addWidget(m_spectrumView, 3);
+        m_spectrumView->hide();
+        connect(toggle, &QPushButton::toggled, m_spectrumView, &QWidget::setVisible);
+    }
 }
 
 void MainWindow::wireTunerSignals()
@@ -329,6 +565,19 @@ void MainWindow::wireTunerSignals()
                 m_tuner->setBaseMidi(midi);
                 m_tuner->setCents(cents);
             });
+    if (m_pitchHistory)
+        connect(m_tracker, &PitchTracker::noteUpdate,
+                m_pitchHistory, &PitchHistoryWidget::addReading);
+    if (m_noteScroll)
+        connect(m_tracker, &PitchTracker::noteUpdate,
+                m_noteScroll, &NoteScrollWidget::addReading);
+    if (m_spectrumView) {
+        connect(m_tracker, &PitchTracker::spectrumUpdated,
+                m_spectrumView, &SpectrumWidget::addFrame);
+        connect(m_spectrumView, &SpectrumWidget::activeChanged, this, [this](bool on){
+            m_tracker->setSpectrumEnabled(on);
+        });
+    }
 
     connect(m_tracker, &PitchTracker::started, this, []{
         qDebug() << "[Tracker] started";
@@ -347,11 +596,30 @@ void MainWindow::wireTunerSignals()
 void MainWindow::setupToolBoxBehavior()
 {
     connect(ui->toolBox, &QToolBox::currentChanged, this, [this](int idx){
-        if (idx == TUNER) startTunerWithPermission();
-        else              m_tracker->stop();
+        ensurePage(idx);   // primeira abertura monta a página
+
+        if (idx == TUNER)   startTunerWithPermission();
+        else if (m_tracker) m_tracker->stop();
+
+        // abre a saída já em silêncio; o Play então só abre o gate
+        if (idx == GENFREQ && toneGen) toneGen->prewarm();
+        if (idx == METRONOME && metro) metro->prewarm();   // também carrega os sons
+
+        releaseIdleAudio();
     });
 }
 
+void MainWindow::releaseIdleAudio()
+{
+    // quem ainda toca (drone, sequência, metrônomo) continua no mix ao trocar
+    // de aba; o resto sai e, sem fontes nem entradas, o AudioEngine fecha a sink
+    const int idx = ui->toolBox->currentIndex();
+    if (toneGen && idx != GENFREQ && !toneGen->isPlaying() && !toneGen->isSequencePlaying())
+        toneGen->releaseAudio();
+    if (metro && idx != METRONOME && !metro->isRunning())
+        metro->releaseAudio();
+}
+
 void MainWindow::startTunerWithPermission()
 {
 #ifdef Q_OS_ANDROID
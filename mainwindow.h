@@ -10,6 +10,7 @@
 #include <QPermission>
 #include <QTimer>
 #include <QButtonGroup>
+#include <QComboBox>
 
 //TODO: teste
 #include "staffnotewidget.h"
@@ -33,6 +34,9 @@ constexpr int MAX_BPM = 300;
 
 class PitchTracker;
 class TunerWidget;
+class NoteScrollWidget;
+class PitchHistoryWidget;
+class SpectrumWidget;
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -47,6 +51,10 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // log de abertura (cold start e custo de cada página) só com
+    // MUSICOOL_STARTUP_LOG definida no ambiente
+    static bool startupLogEnabled();
+
 
 private slots:
     void onMicrophonePermissionChanged(const QPermission &perm);
@@ -59,12 +67,16 @@ private:
 
     PitchTracker  *m_tracker = nullptr;
     TunerWidget  *m_tuner    = nullptr;
+    PitchHistoryWidget *m_pitchHistory = nullptr;   // cents x tempo, sob o ponteiro
+    NoteScrollWidget *m_noteScroll = nullptr;   // notas tocadas
+    SpectrumWidget *m_spectrumView = nullptr;   // diagnóstico, escondido por padrão
     MetronomeWidget *metro   = nullptr;
     ToneGenerator *toneGen   = nullptr;
     StaffNoteWidget *staff   = nullptr;
 
     QButtonGroup *m_group    = nullptr; // measure
     QButtonGroup *b_group    = nullptr; // bpm
+    QComboBox    *m_training = nullptr; // treino de andamento (rampa/lacunas)
 
     void setupTunerInFrame();
     void startTunerWithPermission();
@@ -72,6 +84,16 @@ private:
     void wireTunerSignals();
     void setupStaffInFrame();
 
+    // páginas montadas na primeira abertura da aba (startup só com a About)
+    void ensurePage(int idx);
+    void ensureTunerPage();
+    void ensureToneGenPage();
+    void ensureMetronomePage();
+    void applyTraining();              // treino escolhido -> metrônomo
+
+    // fontes paradas fora da própria aba saem do mix (a sink pode fechar)
+    void releaseIdleAudio();
+
     int noteIdxValue = 0;
     int octaveValue  = 4;
 
@@ -0,0 +1,494 @@
+#include "metronomeengine.h"
+#include <QtMath>
+
+// ---------------- BeatPattern ----------------
+BeatPattern BeatPattern::simple(int beats, int pulsesPerBeat, bool accent)
+{
+    BeatPattern p;
+    p.beats         = qBound(1, beats, 16);
+    p.pulsesPerBeat = qBound(1, pulsesPerBeat, 4);
+    p.levels.resize(p.pulses());
+    for (int i = 0; i < p.pulses(); ++i)
+        p.levels[i] = (i % p.pulsesPerBeat) ? Subdivision : Normal;
+    if (accent) p.levels[0] = Accent;
+    return p;
+}
+
+BeatPattern BeatPattern::compound(int numerator, bool accent)
+{
+    // 6/8 => 2 tempos, 9/8 => 3, 12/8 => 4; cada tempo com 3 colcheias
+    return simple(qMax(1, numerator / 3), 3, accent);
+}
+
+BeatPattern BeatPattern::timeSignature(int numerator, int denominator, int pulsesPerBeat, bool accent)
+{
+    if (denominator == 8 && numerator >= 6 && numerator % 3 == 0)
+        return compound(numerator, accent);
+    return simple(numerator, pulsesPerBeat, accent);
+}
+
+// ---------------- TempoRamp ----------------
+TempoRamp TempoRamp::linear(double from, double to, int bars)
+{
+    TempoRamp r;
+    r.mode     = Linear;
+    r.startBpm = from;
+    r.endBpm   = to;
+    r.rampBars = qMax(1, bars);
+    return r;
+}
+
+TempoRamp TempoRamp::stepped(double from, double to, double step, int everyBars)
+{
+    TempoRamp r;
+    r.mode      = Stepped;
+    r.startBpm  = from;
+    r.endBpm    = to;
+    r.stepBpm   = std::abs(step);
+    r.everyBars = qMax(1, everyBars);
+    return r;
+}
+
+TempoRamp TempoRamp::gaps(int barsOn, int barsOff)
+{
+    TempoRamp r;
+    r.barsOn  = qMax(0, barsOn);
+    r.barsOff = qMax(0, barsOff);
+    return r;
+}
+
+// ---------------- slots duplos (GUI escreve, callback troca) ----------------
+// bit0 = slot ativo, bit1 = há um slot pendente (o inativo)
+static int beginSlotWrite(std::atomic<int>& state, int pendingBit)
+{
+    // retira uma publicação ainda não consumida; sem pendência só a GUI mexe
+    int st = state.load(std::memory_order_acquire);
+    while ((st & pendingBit)
+           && !state.compare_exchange_weak(st, st & ~pendingBit, std::memory_order_acq_rel)) {}
+    return st & 1;  // ativo; a GUI escreve no outro
+}
+
+static bool takeSlot(std::atomic<int>& state, int pendingBit, int* newActive)
+{
+    int st = state.load(std::memory_order_acquire);
+    if (!(st & pendingBit)) return false;
+    if (!state.compare_exchange_strong(st, 1 - (st & 1), std::memory_order_acq_rel))
+        return false; // GUI retirou neste instante
+    *newActive = 1 - (st & 1);
+    return true;
+}
+
+// ---------------- MetronomeEngine ----------------
+void MetronomeEngine::setSampleRate(int sr)
+{
+    // a sink comum é reaberta com o metrônomo tocando (troca de latência):
+    // o relógio continua de onde estava e os pulsos já agendados só são
+    // reescalados se a taxa mudou — zerar m_pos deixaria m_nextBeat e as
+    // camadas lá na frente, mudos pelo tempo que já tinha tocado
+    sr = qMax(8000, sr);
+    if (sr == m_sr) return;
+
+    const double k = double(sr) / m_sr;
+    auto rescale = [&](double at){ return double(m_pos) + (at - double(m_pos)) * k; };
+    m_nextBeat = rescale(m_nextBeat);
+    m_anchorAt = rescale(m_anchorAt);
+    for (LayerState& st : m_lay)
+        if (st.at >= 0.0) st.at = rescale(st.at);
+    m_sr = sr;
+}
+
+void MetronomeEngine::setClicks(const QVector<qint16>& accent, const QVector<qint16>& normal,
+                                const QVector<qint16>& subdivision)
+{
+    const int active = beginSlotWrite(m_setState, kPending);
+    ClickSet& s = m_sets[1 - active];
+    const QVector<qint16>* clips[kLevels] = {&accent, &normal, &subdivision, nullptr};
+    s.pool.clear();
+    s.pool.reserve(accent.size() + normal.size() + subdivision.size());
+    for (int lv = 0; lv < kLevels; ++lv) {
+        s.off[lv] = int(s.pool.size());
+        s.len[lv] = clips[lv] ? int(clips[lv]->size()) : 0;
+        if (clips[lv]) s.pool += *clips[lv];
+    }
+    m_setState.store(active | kPending, std::memory_order_release);
+}
+
+void MetronomeEngine::setPattern(const BeatPattern& pattern)
+{
+    const int active = beginSlotWrite(m_tableState, kPending);
+    PulseTable& t = m_tables[1 - active];
+
+    const int ppb = qBound(1, pattern.pulsesPerBeat, 4);
+    const int n   = qBound(1, pattern.beats * ppb, kMaxPulses);
+    const double swing = qBound(0.0, pattern.swing, 1.0);
+
+    // início de cada pulso (em tempos); swing só faz sentido em pares
+    double start[kMaxPulses + 1];
+    for (int i = 0; i < n; ++i) {
+        double s = double(i) / ppb;
+        if (ppb % 2 == 0 && (i % 2) == 1) s += swing / (3.0 * ppb);
+        start[i] = s;
+    }
+    start[n] = double(n) / ppb;
+
+    for (int i = 0; i < n; ++i) {
+        t.ev[i].clip     = quint8(pattern.level(i));
+        t.ev[i].beat     = quint8(i / ppb);
+        t.ev[i].pulse    = quint8(i);
+        t.ev[i].durBeats = start[i + 1] - start[i];
+    }
+    t.count = n;
+    t.beats = start[n];
+    m_tableState.store(active | kPending, std::memory_order_release);
+}
+
+void MetronomeEngine::setLayers(const QVector<RhythmLayer>& layers)
+{
+    const int active = beginSlotWrite(m_layerState, kPending);
+    LayerSet& ls = m_layerSets[1 - active];
+    ls.pool.clear();
+    for (int l = 0; l < kLayers - 1; ++l) {
+        const bool on = l < layers.size() && layers.at(l).pulses > 0;
+        ls.pulses[l] = on ? qMin(layers.at(l).pulses, kMaxPulses) : 0;
+        ls.gain[l]   = on ? qBound(0.0f, layers.at(l).gain, 1.0f) : 0.0f;
+        ls.off[l]    = int(ls.pool.size());
+        ls.len[l]    = on ? int(layers.at(l).click.size()) : 0;
+        if (on) ls.pool += layers.at(l).click;
+    }
+    m_layerState.store(active | kPending, std::memory_order_release);
+}
+
+void MetronomeEngine::setTempoRamp(const TempoRamp& ramp)
+{
+    const int active = beginSlotWrite(m_rampState, kPending);
+    TempoRamp& r = m_ramps[1 - active];
+    r = ramp;
+    r.startBpm  = qBound(1.0, r.startBpm, 1000.0);
+    r.endBpm    = qBound(1.0, r.endBpm, 1000.0);
+    r.rampBars  = qMax(1, r.rampBars);
+    r.everyBars = qMax(1, r.everyBars);
+    r.stepBpm   = std::abs(r.stepBpm);
+    m_rampState.store(active | kPending, std::memory_order_release);
+}
+
+void MetronomeEngine::setBpm(double bpm)
+{
+    m_bpm.store(qBound(1.0, bpm, 1000.0), std::memory_order_relaxed);
+}
+
+void MetronomeEngine::start()
+{
+    m_startSerial.fetch_add(1, std::memory_order_relaxed);
+    m_runReq.store(true, std::memory_order_release);
+}
+
+void MetronomeEngine::stop()
+{
+    m_runReq.store(false, std::memory_order_release);
+}
+
+MetronomeEngine::Beat MetronomeEngine::lastBeat(int layer) const
+{
+    // leitura consistente dos campos (o serial é gravado por último)
+    const BeatOut& o = m_beat[qBound(0, layer, kLayers - 1)];
+    Beat b;
+    for (;;) {
+        b.serial = o.serial.load(std::memory_order_acquire);
+        b.index  = o.index.load(std::memory_order_relaxed);
+        b.pulse  = o.pulse.load(std::memory_order_relaxed);
+        b.audible = o.audible.load(std::memory_order_relaxed);
+        b.at     = o.at.load(std::memory_order_relaxed);
+        if (o.serial.load(std::memory_order_acquire) == b.serial) return b;
+    }
+}
+
+MetronomeEngine::Stats MetronomeEngine::stats() const
+{
+    Stats st;
+    st.renders         = m_statRenders.load(std::memory_order_relaxed);
+    st.frames          = m_statFrames.load(std::memory_order_relaxed);
+    st.truncatedClicks = m_statTruncated.load(std::memory_order_relaxed);
+    return st;
+}
+
+int MetronomeEngine::readBeats(quint64* cursor, BeatEvent* out, int maxCount) const
+{
+    const quint64 w = m_ringWrite.load(std::memory_order_acquire);
+    quint64 r = *cursor;
+    if (w - r > quint64(kBeatRing)) r = w - kBeatRing;
+
+    const quint64 first = r;
+    int n = 0;
+    for (; r < w && n < maxCount; ++r, ++n) {
+        const RingSlot& s = m_ring[r & (kBeatRing - 1)];
+        const quint32 info = s.info.load(std::memory_order_relaxed);
+        BeatEvent& e = out[n];
+        e.at      = s.at.load(std::memory_order_relaxed);
+        e.layer   = int(info & 0xff);
+        e.index   = int((info >> 8) & 0xff);
+        e.pulse   = int((info >> 16) & 0xff);
+        e.audible = (info >> 24) & 1;
+        e.bpm     = s.bpm.load(std::memory_order_relaxed);
+    }
+
+    // o callback pode ter sobrescrito os mais antigos durante a cópia
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const quint64 w2 = m_ringWrite.load(std::memory_order_relaxed);
+    if (w2 >= first + kBeatRing) {
+        const int lost = int(qMin<quint64>(quint64(n), w2 - kBeatRing + 1 - first));
+        for (int i = lost; i < n; ++i) out[i - lost] = out[i];
+        n -= lost;
+    }
+    *cursor = r;
+    return n;
+}
+
+void MetronomeEngine::pickup()
+{
+    int slot = 0;
+    if (takeSlot(m_setState, kPending, &slot)) {
+        m_set = &m_sets[slot];
+        // o slot antigo volta para a GUI: corta os clicks que ainda apontam para ele
+        for (Voice& v : m_voice)
+            if (v.layer == 0) cutVoice(v);
+    }
+
+    const bool run = m_runReq.load(std::memory_order_acquire);
+    const int serial = m_startSerial.load(std::memory_order_relaxed);
+    if (run && (!m_running || serial != m_seenStart)) {
+        m_seenStart = serial;
+        m_nextBeat  = double(m_pos);
+        m_idx       = 0;
+        m_beatPos   = 0.0;
+        m_bar       = -1;
+        m_rampBar0  = 0;
+        m_rampBeat0 = 0.0;
+        for (LayerState& st : m_lay) st = LayerState{};
+    }
+    m_running = run;
+}
+
+void MetronomeEngine::beginBar()
+{
+    ++m_bar;
+
+    // padrão e rampa novos só entram no início do compasso
+    int slot = 0;
+    if (takeSlot(m_tableState, kPending, &slot))
+        m_table = &m_tables[slot];
+    if (takeSlot(m_layerState, kPending, &slot)) {
+        m_layers = &m_layerSets[slot];
+        for (Voice& v : m_voice)
+            if (v.layer > 0) cutVoice(v);
+    }
+    if (takeSlot(m_rampState, kPending, &slot)) {
+        m_ramp      = &m_ramps[slot];
+        m_rampBar0  = m_bar;
+        m_rampBeat0 = m_beatPos;
+    }
+
+    // camadas recomeçam junto com o compasso principal
+    m_barBeat0 = m_beatPos;
+    for (LayerState& st : m_lay) st = LayerState{0, m_beatPos, -1.0};
+
+    const TempoRamp& r = *m_ramp;
+    const qint64 bars = m_bar - m_rampBar0;
+
+    const int cycle = r.barsOn + r.barsOff;
+    m_barAudible = (r.barsOn <= 0 || r.barsOff <= 0) || (bars % cycle) < r.barsOn;
+
+    if (r.mode == TempoRamp::Stepped) {
+        const double delta = r.stepBpm * double(bars / r.everyBars);
+        m_barBpm = (r.endBpm >= r.startBpm) ? qMin(r.endBpm, r.startBpm + delta)
+                                            : qMax(r.endBpm, r.startBpm - delta);
+    }
+}
+
+double MetronomeEngine::bpmAt(double beat) const
+{
+    const TempoRamp& r = *m_ramp;
+    switch (r.mode) {
+    case TempoRamp::Stepped:
+        return m_barBpm;
+    case TempoRamp::Linear: {
+        const double span = r.rampBars * m_table->beats;
+        const double t = qBound(0.0, (beat - m_rampBeat0) / span, 1.0);
+        return r.startBpm + (r.endBpm - r.startBpm) * t;
+    }
+    default:
+        return m_bpm.load(std::memory_order_relaxed);
+    }
+}
+
+double MetronomeEngine::secondsBetween(double b0, double b1) const
+{
+    const TempoRamp& r = *m_ramp;
+    if (r.mode != TempoRamp::Linear)
+        return (b1 - b0) * 60.0 / bpmAt(b0);   // constante dentro do compasso
+
+    // rampa linear no tempo musical: bpm(b) = a + k*b
+    // => t = 60 * ∫ db / bpm(b) = 60/k * ln(bpm(b1)/bpm(b0)), exato
+    const double end = m_rampBeat0 + r.rampBars * m_table->beats;
+    const double mid = qBound(b0, end, b1);
+    double sec = 0.0;
+    if (mid > b0) {
+        const double k = (r.endBpm - r.startBpm) / (r.rampBars * m_table->beats);
+        const double f0 = bpmAt(b0), f1 = bpmAt(mid);
+        sec += (std::abs(k) < 1e-12) ? (mid - b0) * 60.0 / f0
+                                     : 60.0 / k * std::log(f1 / f0);
+    }
+    if (b1 > mid) sec += (b1 - mid) * 60.0 / r.endBpm;
+    return sec;
+}
+
+void MetronomeEngine::fireBeat()
+{
+    if (m_idx == 0) beginBar();
+
+    const PulseEvent& e = m_table->ev[m_idx];
+    // compasso de lacuna toca o clip mudo (vazio): nada de ramificar por nível
+    const int lv = m_barAudible ? e.clip : int(BeatPattern::Mute);
+    startVoice(m_set->pool.constData() + m_set->off[lv], m_set->len[lv], m_nextBeat, 1.0f, 0);
+
+    m_curBpm.store(bpmAt(m_beatPos), std::memory_order_relaxed);
+    publishBeat(0, e.beat, e.pulse);
+
+    // acumulador fracionário (tempos -> samples pelo mapa de andamento):
+    // nada de truncar o intervalo para inteiro nem de reiniciar a fase
+    const double b0 = m_beatPos;
+    m_beatPos += e.durBeats;
+    const double next = m_nextBeat + secondsBetween(b0, m_beatPos) * double(m_sr);
+
+    // âncora do intervalo: as camadas que caem nele são agendadas a partir daqui
+    m_anchorBeat = b0;
+    m_anchorAt   = m_nextBeat;
+    m_anchorEnd  = m_beatPos;
+    m_nextBeat   = next;
+    for (int l = 0; l < kLayers - 1; ++l) scheduleLayer(l);
+
+    if (++m_idx >= m_table->count) m_idx = 0;
+}
+
+void MetronomeEngine::scheduleLayer(int l)
+{
+    LayerState& st = m_lay[l];
+    const int n = m_layers->pulses[l];
+    if (st.at >= 0.0 || st.next >= n) return;
+    if (st.beat >= m_anchorEnd - 1e-9) return;  // cai num intervalo futuro
+    st.at = m_anchorAt + secondsBetween(m_anchorBeat, st.beat) * double(m_sr);
+}
+
+void MetronomeEngine::fireLayer(int l)
+{
+    LayerState& st = m_lay[l];
+    startVoice(m_layers->pool.constData() + m_layers->off[l], m_barAudible ? m_layers->len[l] : 0,
+               st.at, m_layers->gain[l], l + 1);
+    publishBeat(l + 1, st.next, st.next);
+
+    // N pulsos iguais no compasso principal, sempre a partir do seu início
+    ++st.next;
+    st.beat = m_barBeat0 + m_table->beats * st.next / m_layers->pulses[l];
+    st.at   = -1.0;
+    scheduleLayer(l);
+}
+
+void MetronomeEngine::startVoice(const qint16* data, int len, double exactAt, float gain, int layer)
+{
+    Voice& v = m_voice[m_nextVoice];
+    m_nextVoice = (m_nextVoice + 1) % kVoices;
+    cutVoice(v);                         // voz roubada ainda tocando conta como corte
+    v.data  = data;
+    v.len   = len;
+    v.pos   = 0;
+    v.phase = float(qBound(0.0, double(m_pos) - exactAt, 0.999));
+    v.gain  = gain;
+    v.layer = layer;
+}
+
+void MetronomeEngine::cutVoice(Voice& v)
+{
+    if (v.pos < v.len) m_statTruncated.fetch_add(1, std::memory_order_relaxed);
+    v = Voice{};
+}
+
+void MetronomeEngine::publishBeat(int layer, int index, int pulse)
+{
+    BeatOut& o = m_beat[layer];
+    o.index.store(index, std::memory_order_relaxed);
+    o.pulse.store(pulse, std::memory_order_relaxed);
+    o.at.store(m_pos, std::memory_order_relaxed);
+    o.audible.store(m_barAudible, std::memory_order_relaxed);
+    o.serial.store(++m_serial[layer], std::memory_order_release);
+
+    const quint64 w = m_ringWrite.load(std::memory_order_relaxed);
+    RingSlot& s = m_ring[w & (kBeatRing - 1)];
+    std::atomic_thread_fence(std::memory_order_release); // par do fence do readBeats()
+    s.at.store(m_pos, std::memory_order_relaxed);
+    s.info.store(quint32(layer) | quint32(index) << 8 | quint32(pulse) << 16
+                 | quint32(m_barAudible) << 24, std::memory_order_relaxed);
+    s.bpm.store(m_curBpm.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_ringWrite.store(w + 1, std::memory_order_release);
+}
+
+void MetronomeEngine::mixAdd(float* out, int n, float scale)
+{
+    for (Voice& v : m_voice) {
+        if (v.pos >= v.len) continue;
+        const int m = qMin(n, v.len - v.pos);
+        const qint16* src = v.data + v.pos;
+        // o click começa entre dois samples: interpola na fase exata do pulso
+        const float ph = v.phase, g = v.gain * scale;
+        for (int i = 0; i < m; ++i) {
+            const float a = src[i];
+            const float b = (v.pos + i + 1 < v.len) ? float(src[i + 1]) : 0.0f;
+            out[i] += (a + ph * (b - a)) * g;
+        }
+        v.pos += m;
+    }
+}
+
+void MetronomeEngine::render(float* mix, int frames, float gain)
+{
+    pickup();
+
+    const float scale = gain / 32768.0f;
+    int done = 0;
+    while (done < frames) {
+        int n = frames - done;
+        if (m_running) {
+            // camadas antes do principal: um pulso do fim do compasso não pode
+            // ser zerado pelo beginBar() do compasso seguinte no mesmo sample
+            bool fired = false;
+            for (int l = 0; l < kLayers - 1 && !fired; ++l) {
+                if (m_lay[l].at < 0.0) continue;
+                const qint64 at = qint64(std::ceil(m_lay[l].at));
+                if (at <= m_pos) { fireLayer(l); fired = true; }
+                else n = int(qMin<qint64>(n, at - m_pos));
+            }
+            if (fired) continue;
+
+            // 1º sample inteiro em (ou logo após) a posição exata do pulso
+            const qint64 at = qint64(std::ceil(m_nextBeat));
+            if (at <= m_pos) { fireBeat(); continue; }
+            n = int(qMin<qint64>(n, at - m_pos));
+        }
+        mixAdd(mix + done, n, scale);
+        done  += n;
+        m_pos += n;
+    }
+    m_clock.store(m_pos, std::memory_order_release);
+    m_statRenders.fetch_add(1, std::memory_order_relaxed);
+    m_statFrames.fetch_add(quint64(frames), std::memory_order_relaxed);
+}
+
+void MetronomeEngine::render(qint16* out, int frames)
+{
+    for (int done = 0; done < frames; ) {
+        const int n = qMin(kScratch, frames - done);
+        for (int i = 0; i < n; ++i) m_scratch[i] = 0.0f;
+        render(m_scratch, n, 32768.0f);          // escala 1: unidades de 16-bit
+        for (int i = 0; i < n; ++i)
+            out[done + i] = qint16(qBound(-32768, qRound(m_scratch[i]), 32767));
+        done += n;
+    }
+}
@@ -0,0 +1,263 @@
+#pragma once
+#include <QVector>
+#include <QtGlobal>
+#include <atomic>
+
+// Padrão de pulsos de um compasso: nível por pulso (acento, normal,
+// subdivisão, mudo), compilado pelo MetronomeEngine numa tabela de eventos.
+struct BeatPattern
+{
+    enum Level : quint8 { Accent = 0, Normal = 1, Subdivision = 2, Mute = 3 };
+
+    int    beats         = 4;     // tempos contados pelo BPM
+    int    pulsesPerBeat = 1;     // 1, 2 (colcheias), 3 (tercinas), 4 (semicolcheias)
+    double swing         = 0.0;   // 0 (reto) .. 1 (tercina): atrasa os pulsos ímpares
+    QVector<Level> levels;        // beats * pulsesPerBeat níveis
+
+    int pulses() const { return beats * pulsesPerBeat; }
+    Level level(int pulse) const {
+        return (pulse >= 0 && pulse < levels.size()) ? levels.at(pulse) : Mute;
+    }
+
+    // 2/4, 3/4, 4/4, 5/4... com subdivisão uniforme
+    static BeatPattern simple(int beats, int pulsesPerBeat = 1, bool accent = true);
+    // 6/8, 9/8, 12/8: tempos de semínima pontuada com 3 colcheias cada
+    static BeatPattern compound(int numerator, bool accent = true);
+    // fórmula de compasso: x/8 com x múltiplo de 3 vira composto
+    static BeatPattern timeSignature(int numerator, int denominator,
+                                     int pulsesPerBeat = 1, bool accent = true);
+};
+
+// Treino de andamento: rampa linear ou em degraus (ex.: +2 BPM a cada 4
+// compassos de 60 a 100) e/ou treino com lacunas (N compassos tocando,
+// M em silêncio). Avaliado pelo engine a cada pulso, com fase fracionária.
+struct TempoRamp
+{
+    enum Mode : quint8 { Off = 0, Linear = 1, Stepped = 2 };
+
+    Mode   mode      = Off;
+    double startBpm  = 60.0;
+    double endBpm    = 100.0;
+    int    rampBars  = 16;        // Linear: compassos para ir de start a end
+    double stepBpm   = 2.0;       // Stepped: incremento por degrau
+    int    everyBars = 4;         // Stepped: compassos por degrau
+    int    barsOn    = 0;         // lacunas: compassos tocando (0 = sem lacunas)
+    int    barsOff   = 0;         //          compassos em silêncio
+
+    static TempoRamp linear(double from, double to, int bars);
+    static TempoRamp stepped(double from, double to, double step, int everyBars);
+    static TempoRamp gaps(int barsOn, int barsOff); // andamento fixo, só lacunas
+};
+
+// Camada extra de polirritmia: N pulsos distribuídos por igual no compasso
+// da camada principal (3 contra 2 tempos = 3:2), com timbre e nível próprios.
+struct RhythmLayer
+{
+    int   pulses = 0;             // por compasso (0 = desligada)
+    QVector<qint16> click;        // samples do click desta camada
+    float gain   = 1.0f;          // 0..1
+};
+
+// Núcleo de áudio do metrônomo (só QtCore): conta samples e mistura os
+// clicks pré-calculados em posições exatas, a partir de um acumulador
+// fracionário de samples-por-pulso. Usado pelo MetronomeWidget (stream
+// em pull mode) e pelo render offline.
+//
+// Threads: setters/start/stop vêm da GUI (atomics / slots duplos); render()
+// roda no callback de áudio, percorre a tabela compilada e nunca aloca.
+class MetronomeEngine
+{
+public:
+    MetronomeEngine() = default;
+
+    void setSampleRate(int sr);          // chamar com o stream parado; não zera o relógio
+    int  sampleRate() const { return m_sr; }
+
+    // troca os clicks sem lock (2 slots; vale a partir do próximo bloco)
+    void setClicks(const QVector<qint16>& accent, const QVector<qint16>& normal,
+                   const QVector<qint16>& subdivision);
+
+    // compila o padrão numa tabela de eventos; troca no fim do compasso
+    void setPattern(const BeatPattern& pattern);
+
+    void setBpm(double bpm);             // vale a partir do próximo pulso (sem rampa)
+
+    // camadas de polirritmia (até kLayers-1, além da principal); entram no
+    // próximo início de compasso e compartilham o mesmo relógio de samples
+    void setLayers(const QVector<RhythmLayer>& layers);
+
+    // rampa/lacunas: entram no próximo início de compasso e contam a partir dele
+    void setTempoRamp(const TempoRamp& ramp);
+
+    // andamento efetivo do último pulso (segue a rampa)
+    double currentBpm() const { return m_curBpm.load(std::memory_order_relaxed); }
+
+    void start();                        // 1º pulso no próximo sample renderizado
+    void stop();                         // deixa o click atual terminar
+    bool isRunning() const { return m_runReq.load(std::memory_order_relaxed); }
+
+    // callback: escreve frames samples mono 16-bit (render offline)
+    void render(qint16* out, int frames);
+    // idem, somando em float [-1, 1] (mix do AudioEngine) com ganho
+    void render(float* mix, int frames, float gain = 1.0f);
+
+    // samples renderizados desde a criação (monotônico, atravessa reaberturas)
+    qint64 sampleClock() const { return m_clock.load(std::memory_order_acquire); }
+
+    // contadores do callback (só crescem; a UI compara leituras)
+    struct Stats {
+        quint64 renders         = 0;     // chamadas de render()
+        quint64 frames          = 0;
+        quint64 truncatedClicks = 0;     // click cortado antes do fim (sem voz livre / troca de som)
+    };
+    Stats stats() const;
+
+    static constexpr int kLayers = 3;    // principal + 2 camadas de polirritmia
+
+    // último pulso disparado de cada camada (para a UI)
+    struct Beat {
+        qint64 serial = -1;              // contador monotônico (não zera no start)
+        int    index  = 0;               // tempo 0..beats-1 (camadas: = pulse)
+        int    pulse  = 0;               // pulso 0..pulses-1
+        bool   audible = true;           // false nos compassos de lacuna
+        qint64 at     = 0;               // sample em que o click começa
+    };
+    Beat lastBeat(int layer = 0) const;
+
+    // fila de todos os pulsos disparados, na ordem dos samples: a UI acende
+    // cada um quando a sink chega no seu sample (não quando ele é renderizado)
+    struct BeatEvent {
+        qint64 at      = 0;              // sample em que o click começa
+        int    layer   = 0;              // 0 = principal
+        int    index   = 0;
+        int    pulse   = 0;
+        bool   audible = true;
+        double bpm     = 0.0;            // andamento efetivo no pulso
+    };
+    quint64 beatCursor() const { return m_ringWrite.load(std::memory_order_acquire); }
+    // copia até maxCount eventos a partir de *cursor e avança o cursor;
+    // se a UI ficou para trás mais que a fila, pula para os mais novos
+    int readBeats(quint64* cursor, BeatEvent* out, int maxCount) const;
+
+private:
+    static constexpr int kLevels  = 4;   // índice do clip = BeatPattern::Level
+    static constexpr int kMaxPulses = 64;
+    static constexpr int kPending = 2;   // bit0 = slot ativo, bit1 = pendente
+    static constexpr int kVoices  = 2 * kLayers; // clicks podem se sobrepor em BPM alto
+    static constexpr int kBeatRing = 256;        // potência de 2
+    static constexpr int kScratch  = 512;        // render 16-bit em blocos
+
+    // clips de um conjunto num único bloco contíguo (Mute tem len 0)
+    struct ClickSet {
+        QVector<qint16> pool;
+        int off[kLevels] = {};
+        int len[kLevels] = {};
+    };
+    struct PulseEvent {
+        quint8 clip;                     // BeatPattern::Level
+        quint8 beat;
+        quint8 pulse;
+        double durBeats;                 // até o próximo pulso (em tempos)
+    };
+    struct PulseTable {
+        PulseEvent ev[kMaxPulses];
+        int    count = 0;
+        double beats = 1.0;              // duração do compasso em tempos
+        PulseTable() { ev[0] = PulseEvent{BeatPattern::Accent, 0, 0, 1.0}; count = 1; }
+    };
+    struct LayerSet {
+        QVector<qint16> pool;
+        int   off[kLayers - 1] = {};
+        int   len[kLayers - 1] = {};
+        float gain[kLayers - 1] = {};
+        int   pulses[kLayers - 1] = {};
+    };
+    struct LayerState {
+        int    next = 0;                 // próximo pulso no compasso
+        double beat = 0.0;               // posição (em tempos) do próximo pulso
+        double at   = -1.0;              // sample exato; < 0 = ainda não agendado
+    };
+    struct Voice {
+        const qint16* data = nullptr;
+        int   len   = 0;
+        int   pos   = 0;
+        float phase = 0.0f;              // atraso fracionário do início (0..1 sample)
+        float gain  = 1.0f;
+        int   layer = 0;
+    };
+
+    void pickup();
+    void beginBar();
+    void fireBeat();
+    void fireLayer(int l);
+    void scheduleLayer(int l);
+    void startVoice(const qint16* data, int len, double exactAt, float gain, int layer);
+    void publishBeat(int layer, int index, int pulse);
+    void cutVoice(Voice& v);
+    double bpmAt(double beat) const;
+    double secondsBetween(double b0, double b1) const;
+    void mixAdd(float* out, int n, float scale);
+
+    int m_sr = 44100;
+
+    // GUI -> áudio
+    ClickSet            m_sets[2];
+    std::atomic<int>    m_setState {0};
+    PulseTable          m_tables[2];
+    std::atomic<int>    m_tableState {0};
+    std::atomic<double> m_bpm {120.0};
+    LayerSet            m_layerSets[2];
+    std::atomic<int>    m_layerState {0};
+    TempoRamp           m_ramps[2];
+    std::atomic<int>    m_rampState {0};
+    std::atomic<bool>   m_runReq {false};
+    std::atomic<int>    m_startSerial {0};
+
+    // estado do callback
+    const ClickSet*   m_set   = &m_sets[0];
+    const PulseTable* m_table = &m_tables[0];
+    const LayerSet*   m_layers = &m_layerSets[0];
+    LayerState m_lay[kLayers - 1];
+    double  m_barBeat0    = 0.0;         // tempo em que o compasso atual começou
+    double  m_anchorBeat  = 0.0;         // último pulso principal: tempo, sample exato
+    double  m_anchorAt    = 0.0;         // e fim do seu intervalo (p/ agendar camadas)
+    double  m_anchorEnd   = 0.0;
+    Voice   m_voice[kVoices];
+    int     m_nextVoice   = 0;
+    int     m_seenStart   = 0;
+    bool    m_running     = false;
+    qint64  m_pos         = 0;           // sample atual
+    double  m_nextBeat    = 0.0;         // posição exata (fracionária) do próximo pulso
+    int     m_idx         = 0;           // próximo evento da tabela
+    const TempoRamp* m_ramp = &m_ramps[0];
+    double  m_beatPos     = 0.0;         // tempos desde o start()
+    qint64  m_bar         = -1;          // compassos desde o start()
+    qint64  m_rampBar0    = 0;           // compasso/tempo em que a rampa entrou
+    double  m_rampBeat0   = 0.0;
+    double  m_barBpm      = 120.0;       // degrau atual (Stepped)
+    bool    m_barAudible  = true;
+    qint64  m_serial[kLayers] = {-1, -1, -1}; // pulsos desde sempre
+    float   m_scratch[kScratch];
+
+    // áudio -> GUI
+    std::atomic<qint64> m_clock {0};
+    std::atomic<quint64> m_statRenders {0};
+    std::atomic<quint64> m_statFrames {0};
+    std::atomic<quint64> m_statTruncated {0};
+    std::atomic<double> m_curBpm {120.0};
+    struct BeatOut {
+        std::atomic<bool>   audible {true};
+        std::atomic<qint64> serial {-1};
+        std::atomic<int>    index {0};
+        std::atomic<int>    pulse {0};
+        std::atomic<qint64> at {0};
+    };
+    BeatOut m_beat[kLayers];
+    struct RingSlot {
+        std::atomic<qint64>  at {0};
+        std::atomic<quint32> info {0};   // layer | index<<8 | pulse<<16 | audible<<24
+        std::atomic<double>  bpm {0.0};
+    };
+    RingSlot m_ring[kBeatRing];
+    std::atomic<quint64> m_ringWrite {0};
+};
@@ -1,13 +1,47 @@
 #include "MetronomeWidget.h"
+#include "audiosynth.h"
 
 #include <QPainter>
 #include <QPainterPath>
 #include <QPaintEvent>
 #include <QStyleOption>
-#include <QMediaDevices>
-#include <QAudioDevice>
-#include <QAudioSink>
+#include <QDebug>
 #include <QtMath>
+#include <atomic>
+
+// ---------------- fonte do AudioEngine ----------------
+// O AudioEngine mixa o metrônomo junto com o gerador de tons; o
+// MetronomeEngine decide em que sample cada click começa.
+class MetronomeWidget::ClickSource : public AudioSource
+{
+public:
+    explicit ClickSource(MetronomeEngine* engine)
+        : m_engine(engine), m_cursor(engine->beatCursor()) {}
+
+    void setGain(float g) { m_gain.store(qBound(0.0f, g, 1.0f), std::memory_order_relaxed); }
+
+    void prepare(int sampleRate) override { m_engine->setSampleRate(sampleRate); }
+
+    void render(float* mix, int frames, qint64 clock) override
+    {
+        // emudecido continua andando: o relógio do metrônomo segue o stream
+        const float gain = m_gain.load(std::memory_order_relaxed);
+        const qint64 at0 = m_engine->sampleClock();
+        m_engine->render(mix, frames, gain);
+
+        // clicks deste bloco no relógio comum: o afinador mascara esses frames
+        MetronomeEngine::BeatEvent ev[8];
+        for (int n; (n = m_engine->readBeats(&m_cursor, ev, 8)) > 0; )
+            for (int i = 0; i < n; ++i)
+                if (gain > 0.0f && ev[i].audible)
+                    AudioEngine::shared().markTransient(clock + (ev[i].at - at0));
+    }
+
+private:
+    MetronomeEngine*   m_engine;
+    quint64            m_cursor;          // fila de batidas, lida no callback
+    std::atomic<float> m_gain {0.85f};
+};
 
 // ---------------- ctor/dtor ----------------
 MetronomeWidget::MetronomeWidget(QWidget *parent)
@@ -17,23 +51,136 @@ MetronomeWidget::MetronomeWidget(QWidget *parent)
     setMinimumHeight(120);
 
     m_timer.setTimerType(Qt::PreciseTimer);
-    connect(&m_timer, &QTimer::timeout, this, &MetronomeWidget::onBeat);
+    m_timer.setInterval(5);
+    connect(&m_timer, &QTimer::timeout, this, &MetronomeWidget::pollBeat);
+
+    m_engine.setSampleRate(m_sampleRate);
+    m_engine.setBpm(m_bpm);
+    m_engine.setPattern(m_pattern);
+    m_scratch.resize(1024);
+    m_pendingBeats.reserve(MetronomeEngine::kLayers * 64);
+    m_source = new ClickSource(&m_engine);
+    m_source->setGain(m_volume);
 }
 
 MetronomeWidget::~MetronomeWidget()
 {
     stop();
-    if (m_sink) { m_sink->stop(); m_sink->deleteLater(); m_sink = nullptr; }
+    AudioEngine::shared().removeSource(m_source);   // espera o callback largar a fonte
+    delete m_source;
 }
 
 // ---------------- parâmetros públicos ----------------
 void MetronomeWidget::setBeatsPerMeasure(int beats)
 {
-    if (beats < 2) beats = 2;
-    if (beats > 4) beats = 4;
-    if (m_beats == beats) return;
-    m_beats = beats;
+    beats = qBound(1, beats, 12);
+    BeatPattern p = BeatPattern::simple(beats, m_pattern.pulsesPerBeat, m_accentOn);
+    p.swing = m_pattern.swing;
+    // mesmo padrão (tempos, subdivisão e acentos): não reinicia a contagem
+    if (p.beats == m_pattern.beats && p.pulsesPerBeat == m_pattern.pulsesPerBeat
+        && p.levels == m_pattern.levels)
+        return;
+    m_pattern = p;
+    applyPattern();
+}
+
+void MetronomeWidget::setSubdivision(int pulsesPerBeat)
+{
+    pulsesPerBeat = qBound(1, pulsesPerBeat, 4);
+    if (m_pattern.pulsesPerBeat == pulsesPerBeat) return;
+    const double swing = m_pattern.swing;
+    m_pattern = BeatPattern::simple(m_pattern.beats, pulsesPerBeat, m_accentOn);
+    m_pattern.swing = swing;
+    applyPattern();
+}
+
+void MetronomeWidget::setTimeSignature(int numerator, int denominator)
+{
+    const double swing = m_pattern.swing;
+    m_pattern = BeatPattern::timeSignature(qBound(1, numerator, 16), denominator,
+                                           m_pattern.pulsesPerBeat, m_accentOn);
+    m_pattern.swing = swing;
+    applyPattern();
+}
+
+void MetronomeWidget::setSwing(double swing01)
+{
+    m_pattern.swing = qBound(0.0, swing01, 1.0);
+    applyPattern();
+}
+
+void MetronomeWidget::setPattern(const BeatPattern& p)
+{
+    m_pattern = p;
+    m_pattern.beats         = qBound(1, p.beats, 16);
+    m_pattern.pulsesPerBeat = qBound(1, p.pulsesPerBeat, 4);
+    m_pattern.levels.resize(m_pattern.pulses(), BeatPattern::Normal);
+    applyPattern();
+}
+
+void MetronomeWidget::setTempoRamp(const TempoRamp& r)
+{
+    m_ramp = r;
+    m_engine.setTempoRamp(m_ramp);      // entra no próximo início de compasso
+    m_shownBpm = (m_ramp.mode == TempoRamp::Off) ? double(m_bpm) : m_ramp.startBpm;
+    update();
+}
+
+void MetronomeWidget::clearTempoRamp()
+{
+    setTempoRamp(TempoRamp{});
+}
+
+void MetronomeWidget::setPolyrhythm(const QVector<int>& pulsesPerBar)
+{
+    m_polyPulses.clear();
+    for (int n : pulsesPerBar) {
+        if (n <= 0) continue;
+        m_polyPulses.append(qBound(1, n, 16));
+        if (m_polyPulses.size() == kExtra) break;
+    }
+    for (int l = 0; l < kExtra; ++l) m_layerPulse[l] = 0;
+    applyLayers();
+    updateGeometry();
+    update();
+}
+
+void MetronomeWidget::setDisplayedPulse(int pulse)
+{
+    const int n = qMax(1, m_pattern.pulses());
+    m_currentPulse = ((pulse % n) + n) % n;
+    m_currentBeat  = m_currentPulse / qMax(1, m_pattern.pulsesPerBeat);
+    for (int l = 0; l < m_polyPulses.size(); ++l)
+        m_layerPulse[l] = m_currentPulse * m_polyPulses.at(l) / n;
+    update();
+}
+
+void MetronomeWidget::setLayerGain(int layer, float gain01)
+{
+    if (layer < 1 || layer > kExtra) return;
+    m_layerGain[layer - 1] = qBound(0.0f, gain01, 1.0f);
+    applyLayers();
+}
+
+void MetronomeWidget::applyLayers()
+{
+    QVector<RhythmLayer> layers;
+    for (int l = 0; l < m_polyPulses.size(); ++l) {
+        RhythmLayer r;
+        r.pulses = m_polyPulses.at(l);
+        r.click  = m_clickLayer[l];
+        r.gain   = m_layerGain[l];
+        layers.append(r);
+    }
+    m_engine.setLayers(layers);          // entra no próximo início de compasso
+}
+
+void MetronomeWidget::applyPattern()
+{
+    m_beats = m_pattern.beats;
     m_currentBeat = 0;
+    m_currentPulse = 0;
+    m_engine.setPattern(m_pattern);     // entra no próximo início de compasso
     update();
 }
 
@@ -42,10 +189,8 @@ void MetronomeWidget::setBpm(int bpm)
     bpm = qBound(30, bpm, 300);
     if (m_bpm == bpm) return;
     m_bpm = bpm;
-    if (m_running) {
-        const int intervalMs = int(60000.0 / double(m_bpm));
-        m_timer.start(intervalMs);
-    }
+    m_engine.setBpm(m_bpm);      // sem reiniciar: vale a partir da próxima batida
+    if (m_ramp.mode == TempoRamp::Off) m_shownBpm = m_bpm;
     update();
 }
 
@@ -57,17 +202,25 @@ void MetronomeWidget::setRunning(bool on)
 void MetronomeWidget::setAudioEnabled(bool on)
 {
     m_audioOn = on;
+    // o stream continua sendo o relógio; só emudece
+    m_source->setGain(m_audioOn ? m_volume : 0.0f);
 }
 
 void MetronomeWidget::setAccentEnabled(bool on)
 {
     m_accentOn = on;
+    if (m_pattern.levels.isEmpty()) return;
+    BeatPattern::Level& first = m_pattern.levels.first();
+    if (first == BeatPattern::Accent || first == BeatPattern::Normal) {
+        first = on ? BeatPattern::Accent : BeatPattern::Normal;
+        applyPattern();
+    }
 }
 
 void MetronomeWidget::setVolume(float vol01)
 {
     m_volume = qBound(0.0f, vol01, 1.0f);
-    if (m_sink) m_sink->setVolume(m_volume);
+    m_source->setGain(m_audioOn ? m_volume : 0.0f);
 }
 
 void MetronomeWidget::setDownbeatHz(double hz)
@@ -76,6 +229,18 @@ void MetronomeWidget::setDownbeatHz(double hz)
     prepareClicks();
 }
 
+void MetronomeWidget::setClickSound(const QString& name)
+{
+    if (m_sound == name) return;
+    m_sound = name;
+    prepareClicks();
+}
+
+void MetronomeWidget::setOutputLatencyMs(double ms)
+{
+    m_outLatencyMs = qBound(0.0, ms, 300.0);
+}
+
 void MetronomeWidget::setUpbeatHz(double hz)
 {
     m_fUpbeat = qBound(100.0, hz, 4000.0);
@@ -83,130 +248,237 @@ void MetronomeWidget::setUpbeatHz(double hz)
 }
 
 // ---------------- controle ----------------
+void MetronomeWidget::prewarm()
+{
+    ensureAudio();
+}
+
+void MetronomeWidget::releaseAudio()
+{
+    stop();
+    // sai do mix; a sink fecha quando ninguém mais a usa
+    AudioEngine::shared().removeSource(m_source);
+}
+
 void MetronomeWidget::start()
 {
     if (m_running) return;
 
     ensureAudio();
-    m_currentBeat = m_beats - 1;                 // << prepara para virar para 0 no primeiro tick
-
-    const int intervalMs = int(60000.0 / double(m_bpm));
-    m_timer.start(intervalMs);
+    m_beatCursor = m_engine.beatCursor();         // ignora batidas de execuções anteriores
+    m_pendingBeats.clear();
+    m_heard = m_engine.sampleClock();
+    m_engine.start();                            // o 1 (downbeat) sai no próximo bloco do mix
+
+    // com o AudioEngine aberto o stream já está rodando; sem device, relógio virtual
+    if (!inMix()) {
+        m_virtualBase = m_engine.sampleClock();
+        m_wallClock.start();
+    }
+    m_timer.start();
     m_running = true;
-
-    onBeat();                                    // toca imediatamente o 1 (downbeat)
 }
 
 void MetronomeWidget::stop()
 {
     if (!m_running) return;
+    m_engine.stop();
     m_timer.stop();
+    m_pendingBeats.clear();      // o que já está na fila da sink ainda toca, mas não acende
     m_running = false;
+    logAudioStats();
     update();
 }
 
-// ---------------- áudio helpers ----------------
-void MetronomeWidget::ensureAudio()
+// ---------------- estatísticas ----------------
+MetronomeWidget::AudioStats MetronomeWidget::audioStats() const
 {
-    if (!m_audioOn) return;
-
-    // cria/recria a saída se necessário
-    if (!m_sink) {
-        QAudioDevice dev = QMediaDevices::defaultAudioOutput();
-        QAudioFormat fmt;
-        fmt.setSampleRate(m_sampleRate);
-        fmt.setChannelCount(1);
-        fmt.setSampleFormat(QAudioFormat::Int16);
-
-        if (!dev.isFormatSupported(fmt)) {
-            fmt = dev.preferredFormat();
-            m_sampleRate = fmt.sampleRate();
-        }
+    // o stream é do AudioEngine (compartilhado); o corte de clicks é nosso
+    const AudioEngine::Stats ae = AudioEngine::shared().stats();
+    AudioStats st;
+    st.callbacks        = ae.callbacks;
+    st.frames           = ae.frames;
+    st.lateCallbacks    = ae.lateCallbacks;
+    st.shortReads       = ae.shortReads;
+    st.maxCallbackGapMs = ae.maxCallbackGapMs;
+    st.truncatedClicks  = m_engine.stats().truncatedClicks - m_engineStatsBase.truncatedClicks;
+    return st;
+}
 
-        m_sink = new QAudioSink(dev, fmt, this);
-        m_sink->setVolume(m_volume);
-        m_out = m_sink->start();
+void MetronomeWidget::resetAudioStats()
+{
+    AudioEngine::shared().resetStats();
+    m_engineStatsBase = m_engine.stats();
+}
 
-        prepareClicks();
-    } else if (!m_out) {
-        m_out = m_sink->start();
-    }
+void MetronomeWidget::logAudioStats() const
+{
+    if (!inMix()) return;
+    const AudioStats st = audioStats();
+    qInfo() << "[Metronome] callbacks" << st.callbacks << "frames" << st.frames
+            << "late" << st.lateCallbacks << "short" << st.shortReads
+            << "truncated" << st.truncatedClicks
+            << "max-gap-ms" << st.maxCallbackGapMs;
 }
 
-static QVector<qint16> genClick(int sr, double hz, int ms, float amp = 0.9f)
+// ---------------- áudio helpers ----------------
+void MetronomeWidget::ensureAudio()
 {
-    const int N = qMax(1, (sr * ms) / 1000);
-    QVector<qint16> out;
-    out.resize(N);
-    const double w = 2.0 * M_PI * hz / double(sr);
+    if (!m_audioOn || inMix()) return;
 
-    // janela curta (fade in/out) para evitar estalos
-    const int fade = qMax(1, sr / 1000 * 2); // ~2 ms
-    for (int i=0; i<N; ++i) {
-        double env = 1.0;
-        if (i < fade) env = double(i) / fade;
-        else if (i > N - 1 - fade) env = double(N - 1 - i) / fade;
+    AudioEngine& ae = AudioEngine::shared();
+    if (!ae.open()) return;      // sem device: segue com o relógio virtual
+    m_sampleRate = ae.sampleRate();
+    ae.addSource(m_source);      // prepare(): engine na taxa do stream
 
-        double s = amp * env * std::sin(w * i);
-        s = qBound(-1.0, s, 1.0);
-        out[i] = qint16(s * 32767.0);
-    }
-    return out;
+    // decodifica/reamostra o banco inteiro agora, uma vez, na taxa da sink
+    m_bank.load(m_sampleRate);
+    prepareClicks();
 }
 
-void MetronomeWidget::prepareClicks()
+bool MetronomeWidget::inMix() const
 {
-    if (!m_sink) return; // será chamado no ensureAudio novamente
-    const int sr = m_sink->format().sampleRate();
-    // duração curta ~35 ms (não atrapalha BPM alto)
-    m_clickDown = genClick(sr, m_fDownbeat, 40, 0.95f);
-    m_clickUp   = genClick(sr, m_fUpbeat,   32, 0.85f);
+    const AudioEngine& ae = AudioEngine::shared();
+    return ae.isOpen() && ae.hasSource(m_source);
 }
 
-void MetronomeWidget::playClick(bool downbeat)
+void MetronomeWidget::prepareClicks()
 {
-    if (!m_audioOn || !m_sink || !m_out) return;
+    if (!inMix()) return; // será chamado no ensureAudio novamente
+    const int sr = m_sampleRate;
+    const int sound = m_sound.isEmpty() ? -1 : m_bank.indexOf(m_sound);
+    if (sound >= 0) {
+        // só copia do pool: já está decodificado e na taxa da sink
+        m_clickDown = m_bank.accent(sound);
+        m_clickUp   = m_bank.normal(sound);
+        m_clickSub  = m_bank.subdivision(sound);
+    } else {
+        // duração curta ~35 ms (não atrapalha BPM alto)
+        m_clickDown = genClick(sr, m_fDownbeat, 40, 0.95f);
+        m_clickUp   = genClick(sr, m_fUpbeat,   32, 0.85f);
+        m_clickSub  = genClick(sr, m_fUpbeat,   20, 0.45f);  // subdivisão: mais curto e fraco
+    }
+    m_engine.setClicks(m_clickDown, m_clickUp, m_clickSub);
 
-    const QVector<qint16>& v = downbeat ? m_clickDown : m_clickUp;
-    if (v.isEmpty()) return;
+    for (int l = 0; l < kExtra; ++l)
+        m_clickLayer[l] = genClick(sr, m_fLayer[l], 24, 0.8f);
+    applyLayers();
+}
 
-    const char* ptr = reinterpret_cast<const char*>(v.constData());
-    const int   len = v.size() * int(sizeof(qint16));
-    m_out->write(ptr, len);
+void MetronomeWidget::advanceVirtualClock()
+{
+    // sem device: renderiza em silêncio até o "agora" só para andar o relógio
+    const qint64 target = m_virtualBase + m_wallClock.nsecsElapsed() * m_sampleRate / 1000000000LL;
+    while (m_engine.sampleClock() < target) {
+        const int n = int(qMin<qint64>(m_scratch.size(), target - m_engine.sampleClock()));
+        m_engine.render(m_scratch.data(), n);
+    }
 }
 
-// ---------------- tick ----------------
-void MetronomeWidget::onBeat()
+qint64 MetronomeWidget::heardSample()
 {
-    // 0,1,2,3...
-    m_currentBeat = (m_currentBeat + 1) % m_beats;
+    // renderizado - o que ainda está na fila da sink - latência do device;
+    // o clock do metrônomo é lido antes do relógio do AudioEngine: se um
+    // callback (thread de áudio) cair no meio, a estimativa atrasa um bloco
+    // em vez de adiantar
+    qint64 heard = m_engine.sampleClock();
+    if (inMix()) {
+        const qint64 queued = AudioEngine::shared().queuedFrames();
+        heard -= queued + qint64(m_outLatencyMs * m_sampleRate / 1000.0);
+    }
+    m_heard = qMax(m_heard, heard);
+    return m_heard;
+}
 
-    const bool isDown = (m_currentBeat == 0);
-    if (m_audioOn) playClick(isDown && m_accentOn);
+// ---------------- tick (UI) ----------------
+void MetronomeWidget::pollBeat()
+{
+    if (!inMix()) advanceVirtualClock();
+
+    // pulsos novos entram na fila; só acendem quando o áudio chega neles
+    MetronomeEngine::BeatEvent ev[32];
+    for (int n; (n = m_engine.readBeats(&m_beatCursor, ev, 32)) > 0; )
+        for (int i = 0; i < n; ++i) m_pendingBeats.append(ev[i]);
+    if (m_pendingBeats.isEmpty()) return;
+
+    const qint64 heard = heardSample();
+    const int ppb = qMax(1, m_pattern.pulsesPerBeat);
+    bool mainMoved = false, bpmMoved = false;
+    int shown = 0;
+    for (; shown < m_pendingBeats.size(); ++shown) {
+        const MetronomeEngine::BeatEvent& e = m_pendingBeats.at(shown);
+        if (e.at > heard) break;
+
+        if (e.layer > 0) {
+            // camadas extras: só a faixa da camada que andou é redesenhada
+            if (e.layer > m_polyPulses.size()) continue;
+            m_layerPulse[e.layer - 1] = e.pulse;
+            update(rowArea(e.layer).toAlignedRect().adjusted(-2, -2, 2, 2));
+            continue;
+        }
 
-    emit tick(m_currentBeat, isDown);
+        m_currentBeat  = e.index;
+        m_currentPulse = e.pulse;
+        m_barAudible   = e.audible;
+        mainMoved      = true;
 
-    update();     // o repaint agora reflete exatamente a batida tocada
+        if (std::abs(e.bpm - m_shownBpm) >= 0.05) {
+            m_shownBpm = e.bpm;
+            bpmMoved   = true;
+        }
+        // tick só nos tempos; as subdivisões só acendem na tela
+        if (e.pulse % ppb == 0)
+            emit tick(m_currentBeat, m_currentBeat == 0);
+    }
+    m_pendingBeats.remove(0, shown);
+
+    if (bpmMoved) emit tempoChanged(m_shownBpm);
+    if (!mainMoved) return;
+    if (bpmMoved || rowCount() == 1) update();
+    else update(rowArea(0).toAlignedRect().adjusted(-2, -2, 2, 2));
 }
 
 
 // ---------------- pintura ----------------
-void MetronomeWidget::paintEvent(QPaintEvent*)
+void MetronomeWidget::paintEvent(QPaintEvent* e)
 {
+    m_textCache.checkDpr(devicePixelRatioF());
     QPainter g(this);
     g.setRenderHint(QPainter::Antialiasing, true);
 
     drawBackground(g);
-    drawBeatSquares(g);
+    // com camadas, cada batida invalida só a sua faixa
+    for (int row = 0; row < rowCount(); ++row) {
+        const QRectF area = rowArea(row);
+        if (!e->rect().intersects(area.toAlignedRect().adjusted(-2, -2, 2, 2))) continue;
+        if (row == 0) drawBeatSquares(g, area);
+        else          drawLayerRow(g, area, row - 1);
+    }
 
     // BPM no canto
     g.setPen(m_text);
-    QFont f = font();
-    f.setBold(true);
-    f.setPointSizeF(qMax(9.0, height() * 0.13));
-    g.setFont(f);
-    const QString bpmTxt = QString::number(m_bpm) + " BPM";
-    g.drawText(rect().adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, bpmTxt);
+    g.setFont(m_textCache.font(kBpmFont, font(), qMax(9.0, height() * 0.13), true));
+    const int bpm = qRound(m_shownBpm);
+    TextCache::draw(g, rect().adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop,
+                    m_textCache.text(kBpmFont, bpm, [bpm]{
+                        return QString::number(bpm) + QStringLiteral(" BPM"); }));
+}
+
+void MetronomeWidget::changeEvent(QEvent* e)
+{
+    if (e->type() == QEvent::FontChange) m_textCache.invalidate();
+    QWidget::changeEvent(e);
+}
+
+void MetronomeWidget::drawNumber(QPainter& g, const QRectF& r, int slot, qreal d,
+                                 bool bold, int number)
+{
+    // um slot por (faixa, negrito): o tamanho de cada faixa muda em
+    // resize/troca de padrão e só então a fonte e os textos são refeitos
+    slot += bold ? 1 : 0;
+    g.setFont(m_textCache.font(slot, font(), qMax(7.0, d * 0.40), bold));
+    TextCache::draw(g, r, Qt::AlignCenter,
+                    m_textCache.text(slot, number, [number]{ return QString::number(number); }));
 }
 
 void MetronomeWidget::drawBackground(QPainter &g)
@@ -214,55 +486,88 @@ void MetronomeWidget::drawBackground(QPainter &g)
     g.fillRect(rect(), m_bg);
 }
 
-void MetronomeWidget::drawBeatSquares(QPainter &g)
+QRectF MetronomeWidget::rowArea(int row) const
 {
-    const int n = m_beats;
+    // área útil dividida em faixas iguais: principal em cima, camadas abaixo
+    const qreal m = qMin(width(), height() / qreal(rowCount())) * 0.10;
+    const QRectF area = QRectF(rect()).marginsRemoved(QMarginsF(m, m*1.3, m, m*0.8));
+    const qreal h = area.height() / rowCount();
+    return QRectF(area.left(), area.top() + row * h, area.width(), h);
+}
 
-    // área útil
-    const qreal m = qMin(width(), height()) * 0.10;
-    QRectF area = QRectF(rect()).marginsRemoved(QMarginsF(m, m*1.3, m, m*0.8));
+void MetronomeWidget::drawLayerRow(QPainter &g, const QRectF& area, int layer)
+{
+    // camada de polirritmia: N círculos espaçados pelo compasso inteiro,
+    // alinhados ao 1º tempo da faixa principal
+    const int n = qMax(1, m_polyPulses.value(layer, 1));
+    const qreal cellW = area.width() / n;
+    const qreal d = qMin(area.height() * 0.8, cellW * 0.8);
 
+    const QColor hl = m_highlightLayer[layer];
+    for (int i = 0; i < n; ++i) {
+        const qreal cx = area.left() + i * cellW + d / 2.0;
+        const QRectF r(cx - d / 2.0, area.center().y() - d / 2.0, d, d);
+        const bool active = (i == m_layerPulse[layer]);
 
+        QColor fill = active ? hl : m_box;
+        if (active && !m_barAudible) fill.setAlpha(90);
+        g.setPen(QPen(m_boxBorder, 1.2));
+        g.setBrush(fill);
+        g.drawEllipse(r);
+
+        g.setPen(m_text);
+        drawNumber(g, r, kLayerFont + 2 * layer, d, active, i + 1);
+    }
+}
+
+void MetronomeWidget::drawBeatSquares(QPainter &g, const QRectF& area)
+{
+    // um círculo por pulso do padrão; subdivisões menores, mudos só contorno
+    const int n   = qMax(1, m_pattern.pulses());
+    const int ppb = qMax(1, m_pattern.pulsesPerBeat);
 
-    // dimensões dos quadrados
-    const qreal gap = qMax<qreal>(6.0, area.width() * 0.02);
+    // dimensões das células
+    const qreal gap = qMax<qreal>(n > 8 ? 3.0 : 6.0, area.width() * (n > 8 ? 0.008 : 0.02));
     const qreal wTot = area.width() - gap * (n - 1);
-    const qreal boxW = qMax<qreal>(40.0, wTot / n);
-    const qreal boxH = qMin<qreal>(qMax<qreal>(50.0, area.height()), boxW * 0.9);
+    const qreal boxW = qMax<qreal>(8.0, wTot / n);
+    const qreal minH = (rowCount() == 1) ? 50.0 : 0.0;   // com camadas, cabe na faixa
+    const qreal boxH = qMin<qreal>(qMax<qreal>(minH, area.height()), boxW * 0.9);
     const qreal y = area.center().y() - boxH / 2.0;
-    const qreal radius = qMin(boxW, boxH) * 0.18;
 
     QPen pen(m_boxBorder, 1.2);
     for (int i = 0; i < n; ++i) {
         const qreal x = area.left() + i * (boxW + gap);
+        const BeatPattern::Level lv = m_pattern.level(i);
+        const bool onBeat = (i % ppb) == 0;
 
         // torna o “box” um círculo: usa o menor dos dois lados como diâmetro
-        const qreal d  = qMin(boxW, boxH);
-        const qreal yC = y + (boxH - d) / 2.0;
-        QRectF r(x, yC, d, d);
+        const qreal dBox = qMin(boxW, boxH);
+        const qreal d    = onBeat ? dBox : dBox * 0.6;
+        const QRectF r(x + (boxW - d) / 2.0, y + (boxH - d) / 2.0, d, d);
 
-        const bool active = (i == m_currentBeat);
-        const bool down   = (i == 0);
+        const bool active = (i == m_currentPulse);
+        const bool down   = (lv == BeatPattern::Accent);
 
         QColor fill = m_box;
         if (active) fill = down ? m_highlightDn : m_highlightUp;
+        if (active && !m_barAudible) fill.setAlpha(90);   // lacuna: só a luz, sem som
+        if (lv == BeatPattern::Mute && !active) fill = m_bg;
 
         // fundo do círculo
         g.setPen(Qt::NoPen);
         g.setBrush(fill);
         g.drawEllipse(r);
 
-        // borda
-        g.setPen(pen);
+        // borda (tracejada nos pulsos mudos)
+        QPen border = pen;
+        if (lv == BeatPattern::Mute) border.setStyle(Qt::DashLine);
+        g.setPen(border);
         g.setBrush(Qt::NoBrush);
         g.drawEllipse(r);
 
-        // número do tempo (centralizado no círculo)
-        QFont f = font();
-        f.setBold(active);
-        f.setPointSizeF(qMax(10.0, d * 0.40));
-        g.setFont(f);
+        // número do tempo (centralizado no círculo), só nos tempos
+        if (!onBeat) continue;
         g.setPen(QColor("#EEEEEE"));
-        g.drawText(r, Qt::AlignCenter, QString::number(i + 1));
+        drawNumber(g, r, kBeatFont, d, active, i / ppb + 1);
     }
 }
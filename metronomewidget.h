@@ -3,9 +3,11 @@
 #include <QTimer>
 #include <QVector>
 #include <QColor>
-
-class QAudioSink;   // Qt 6
-class QIODevice;
+#include <QElapsedTimer>
+#include "metronomeengine.h"
+#include "clickbank.h"
+#include "audioengine.h"
+#include "textcache.h"
 
 class MetronomeWidget : public QWidget
 {
@@ -15,66 +17,150 @@ public:
     ~MetronomeWidget() override;
 
     // Parâmetros de controle
-    void setBeatsPerMeasure(int beats); // aceita 2, 3 ou 4
+    void setBeatsPerMeasure(int beats); // 1..12 (compasso simples)
+    void setSubdivision(int pulsesPerBeat); // 1, 2 (colcheias), 3 (tercinas), 4 (semicolcheias)
+    void setTimeSignature(int numerator, int denominator); // 5/4, 6/8, 9/8, 12/8...
+    void setSwing(double swing01);      // 0 (reto) .. 1 (tercina)
+    void setPattern(const BeatPattern& p); // níveis por pulso (acento/normal/sub/mudo)
+    void setTempoRamp(const TempoRamp& r); // treino: rampa de BPM e/ou lacunas
+    // polirritmia: pulsos por compasso de cada camada extra ({3} sobre 2 tempos = 3:2)
+    void setPolyrhythm(const QVector<int>& pulsesPerBar);
+    void setLayerGain(int layer, float gain01); // camada extra 1..2, 0..1
+    void clearTempoRamp();
     void setBpm(int bpm);               // 30..300
     void setRunning(bool on);           // start/stop visual + som
     void setAudioEnabled(bool on);
     void setAccentEnabled(bool on);
     void setVolume(float vol01);        // 0..1
     void setDownbeatHz(double hz);      // frequência do 1º tempo
+    // latência de saída além do buffer da sink (DAC/driver), para a luz
+    // acender quando o click é ouvido; 0..300 ms
+    void setOutputLatencyMs(double ms);
     void setUpbeatHz(double hz);        // frequência dos demais
+    // som do click: "" = senoide (setDownbeatHz/setUpbeatHz) ou um nome de
+    // ClickBank::names() ("woodblock", "cowbell"...)
+    void setClickSound(const QString& name);
+    // só a parte visual: acende o pulso (0..pulses-1) e o pulso equivalente
+    // das camadas, sem tocar nem mexer no relógio (capturas/benchmark)
+    void setDisplayedPulse(int pulse);
 
     // Estado
     int  beatsPerMeasure() const { return m_beats; }
+    const BeatPattern& pattern() const { return m_pattern; }
     int  bpm() const             { return m_bpm; }
+    double currentBpm() const    { return m_shownBpm; } // segue a rampa
+    const TempoRamp& tempoRamp() const { return m_ramp; }
+    const QVector<int>& polyrhythm() const { return m_polyPulses; }
     bool isRunning() const       { return m_running; }
+    QString clickSound() const   { return m_sound; }
+
+    // saúde do stream de áudio desde o último resetAudioStats(): erros de
+    // tempo ficam visíveis em vez de virarem clicks cortados em silêncio
+    struct AudioStats {
+        quint64 callbacks       = 0;     // readData() pedidos pela sink
+        quint64 frames          = 0;
+        quint64 lateCallbacks   = 0;     // intervalo entre callbacks > buffer da sink
+        quint64 shortReads      = 0;     // readData devolveu menos que o pedido
+        quint64 truncatedClicks = 0;     // click cortado antes do fim
+        double  maxCallbackGapMs = 0.0;
+    };
+    AudioStats audioStats() const;
+    void resetAudioStats();
 
 signals:
     // Notifica a batida (0..beats-1), útil se quiser sincronizar algo externo
     void tick(int beatIndex, bool isDownbeat);
+    // Andamento efetivo mudou (rampa do treino de andamento)
+    void tempoChanged(double bpm);
 
 public slots:
+    void prewarm();                     // abre a sink e carrega os sons, sem tocar
+    void releaseAudio();                // para e sai do mix (volta ao estado "frio")
     void start();
     void stop();
 
 protected:
     void paintEvent(QPaintEvent*) override;
-    QSize sizeHint() const override { return {560, 160}; }
+    void changeEvent(QEvent* e) override;
+    QSize sizeHint() const override { return {560, 100 + 60 * rowCount()}; }
 
 private slots:
-    void onBeat();
+    void pollBeat();                     // só UI: reflete a última batida do engine
 
 private:
     // desenho
     void drawBackground(QPainter &g);
-    void drawBeatSquares(QPainter &g);
+    void drawBeatSquares(QPainter &g, const QRectF& area);
+    void drawLayerRow(QPainter &g, const QRectF& area, int layer);
+    void drawNumber(QPainter& g, const QRectF& r, int slot, qreal d, bool bold, int number);
+    int  rowCount() const { return 1 + int(m_polyPulses.size()); }
+    QRectF rowArea(int row) const;      // faixa de círculos de cada camada
 
     // áudio
-    void ensureAudio();
+    void ensureAudio();                  // entra no mix do AudioEngine
+    bool inMix() const;
     void prepareClicks();                // (re)gera samples p/ o formato atual
-    void playClick(bool downbeat);
+    void applyLayers();                  // clicks/ganhos das camadas -> engine
+    void applyPattern();                 // compila no engine e redesenha
+    void advanceVirtualClock();          // sem sink: engine segue o relógio de parede
+    qint64 heardSample();                // sample que está saindo no alto-falante
+    void logAudioStats() const;
 
 private:
     // parâmetros
-    int   m_beats       = 4;    // 2,3,4
+    int   m_beats       = 4;    // tempos do padrão atual
+    BeatPattern m_pattern = BeatPattern::simple(4);
     int   m_bpm         = 120;  // 30..300
+    TempoRamp m_ramp;           // Off = andamento fixo
+    double m_shownBpm   = 120.0;
     bool  m_running     = false;
     bool  m_audioOn     = true;
     bool  m_accentOn    = true;
     float m_volume      = 0.85f;
     double m_fDownbeat  = 500.0; // Hz (grave)
     double m_fUpbeat    = 900.0; // Hz
+    QString m_sound;             // vazio = senoide
+
+    // polirritmia (camadas extras sobre o compasso principal)
+    static constexpr int kExtra = MetronomeEngine::kLayers - 1;
+    QVector<int> m_polyPulses;
+    float  m_layerGain[kExtra] = {0.8f, 0.7f};
+    double m_fLayer[kExtra]    = {1400.0, 2200.0}; // Hz: timbres distintos do principal
 
     // estado
     int   m_currentBeat = 0;     // 0..m_beats-1
-    QTimer m_timer;
+    int   m_currentPulse = 0;    // 0..m_pattern.pulses()-1
+    bool  m_barAudible  = true;  // compasso de lacuna do treino
+    QTimer m_timer;              // só notificação da UI (o tempo vem do áudio)
+    int    m_layerPulse[kExtra]  = {0, 0};
 
-    // áudio (Qt Multimedia)
-    QAudioSink* m_sink  = nullptr;
-    QIODevice*  m_out   = nullptr;
+    // pulsos já renderizados esperando o áudio chegar neles
+    quint64 m_beatCursor = 0;
+    QVector<MetronomeEngine::BeatEvent> m_pendingBeats;
+    qint64 m_heard      = 0;     // monotônico (a estimativa não anda para trás)
+    double m_outLatencyMs = 0.0;
+
+    // texto: BPM e números dos círculos como QStaticText (refeitos só em
+    // resize/DPR/fonte); cada faixa tem 2 slots (normal/negrito)
+    enum TextSlot { kBpmFont = 0, kBeatFont = 1, kLayerFont = 3 };
+    TextCache m_textCache;
+
+    // áudio: uma fonte no mix do AudioEngine (sink única do app)
+    class ClickSource;
+    ClickSource*  m_source = nullptr;
+    MetronomeEngine m_engine;    // agenda os clicks no sample exato
+    MetronomeEngine::Stats m_engineStatsBase;
     int         m_sampleRate = 44100;
+
+    // sem áudio (desligado ou sem device): relógio virtual
+    QElapsedTimer   m_wallClock;
+    qint64          m_virtualBase = 0;
+    QVector<qint16> m_scratch;
     QVector<qint16> m_clickDown;  // samples do click do 1º tempo
     QVector<qint16> m_clickUp;    // samples dos demais tempos
+    QVector<qint16> m_clickSub;   // samples das subdivisões
+    ClickBank       m_bank;       // sons do stuff.qrc já na taxa da sink
+    QVector<qint16> m_clickLayer[kExtra];
 
     // paleta (dark)
     QColor m_bg          = QColor("#121212");
@@ -83,4 +169,5 @@ private:
     QColor m_text        = QColor("#EEEEEE");
     QColor m_highlightUp = QColor("#4F8AFF");  // destaque normal
     QColor m_highlightDn = QColor("#22B14C");  // destaque do 1º tempo (verde)
+    QColor m_highlightLayer[kExtra] = { QColor("#F0A030"), QColor("#C060E0") };
 };
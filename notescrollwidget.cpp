@@ -0,0 +1,378 @@
+#include "notescrollwidget.h"
+#include "scrollimage.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFontMetricsF>
+#include <QtMath>
+#include <cmath>
+
+// cor da cabeça por faixa de erro (|cents| < 5, 15, 25, resto)
+static const QColor kErrColor[4] = {
+    QColor(0x3c, 0xb3, 0x71), QColor(0xc8, 0xd0, 0x40),
+    QColor(0xf0, 0xa0, 0x30), QColor(0xe0, 0x48, 0x48)
+};
+
+NoteScrollWidget::NoteScrollWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent, true);
+    setAutoFillBackground(false);
+    setMinimumHeight(90);
+
+    m_notes.resize(kNotes);
+    connect(m_line.frameTimer(), &QTimer::timeout, this, &NoteScrollWidget::stepFrame);
+}
+
+void NoteScrollWidget::setPixelsPerSecond(double pps)
+{
+    m_line.setPxPerMs(qBound(5.0, pps, 1000.0) / 1000.0);
+    rebuild();
+    update();
+}
+
+void NoteScrollWidget::setPreferSharps(bool on)
+{
+    m_preferSharps = on;
+    rebuild();
+    update();
+}
+
+void NoteScrollWidget::setClefImage(const QPixmap& pm)
+{
+    m_clef = pm;
+    rebuild();
+    update();
+}
+
+void NoteScrollWidget::setColors(const QColor& bg, const QColor& lines, const QColor& text)
+{
+    m_colors = {bg, lines, text};
+    rebuild();
+    update();
+}
+
+void NoteScrollWidget::clear()
+{
+    m_count = 0;
+    m_active = false;
+    m_candReads = 0;
+    m_misses = 0;
+    rebuild();
+    update();
+}
+
+// ---------- leituras -> notas
+void NoteScrollWidget::addReading(int midi, double cents, double hz, double confidence)
+{
+    m_line.reading(isVisible(), screen());
+
+    if (hz <= 0.0 || confidence < kMinConfidence || midi < 0 || midi > 127) {
+        m_candReads = 0;
+        if (m_active && ++m_misses >= kGapReads) endNote();
+        return;
+    }
+    m_misses = 0;
+    const qint64 now = lineMs();
+
+    if (m_active && midi == current().midi) {
+        Note& n = current();
+        n.centsSum += cents;
+        ++n.reads;
+        n.lastCents = float(cents);
+        n.endMs = now;
+        m_candReads = 0;
+        return;
+    }
+
+    // outra nota: só abre depois de kStableReads leituras iguais
+    if (m_candReads > 0 && midi == m_candMidi) {
+        ++m_candReads;
+    } else {
+        m_candMidi  = midi;
+        m_candReads = 1;
+        m_candStart = now;
+        m_candSum   = 0.0;
+    }
+    m_candSum += cents;
+    if (m_candReads >= kStableReads) {
+        beginNote(m_candMidi, m_candStart, now, m_candSum, m_candReads, cents);
+        m_candReads = 0;
+    }
+}
+
+void NoteScrollWidget::beginNote(int midi, qint64 startMs, qint64 nowMs,
+                                 double centsSum, int reads, double cents)
+{
+    endNote();
+    Note& n = m_notes[m_count & (kNotes - 1)];
+    ++m_count;
+    n = Note();
+    n.midi      = midi;
+    n.startMs   = startMs;
+    n.endMs     = nowMs;
+    n.centsSum  = centsSum;
+    n.reads     = reads;
+    n.lastCents = float(cents);
+    m_active    = true;
+    m_lastBarMs = nowMs;
+
+    if (!m_img.isNull()) {
+        drawBar(n, startMs, nowMs, float(cents));
+        stampNote(n, true);
+    }
+}
+
+void NoteScrollWidget::endNote()
+{
+    if (!m_active) return;
+    m_active = false;
+    // a cabeça fica com a cor do erro médio da nota inteira
+    if (!m_img.isNull()) stampNote(current(), false);
+}
+
+// ---------- tempo
+void NoteScrollWidget::pause()
+{
+    if (m_line.isPaused()) return;
+    endNote();
+    m_line.pause();
+}
+
+void NoteScrollWidget::stepFrame()
+{
+    if (m_line.idle()) { pause(); return; }
+    if (m_img.isNull()) return;
+
+    const qint64 now = lineMs();
+    const int dx = m_line.scroll(m_img, [this](int x0, int x1){ paintColumns(x0, x1); });
+    if (m_active) {
+        drawBar(current(), m_lastBarMs, now, current().lastCents);
+        m_lastBarMs = now;
+    }
+    if (dx > 0 || m_active) update(m_stripRect.toAlignedRect());
+}
+
+// ---------- imagem
+qreal NoteScrollWidget::yForStep(int step) const
+{
+    return m_yE4 - step * m_gap * 0.5;
+}
+
+int NoteScrollWidget::stepForMidi(int midi, int* octaves) const
+{
+    // letra (C..B = 0..6) de cada classe de altura pela grafia preferida
+    static const int sharpLetter[12] = {0,0,1,1,2,3,3,4,4,5,5,6};
+    static const int flatLetter [12] = {0,1,1,2,2,3,4,4,5,5,6,6};
+    const int pc  = midi % 12;
+    const int oct = midi / 12 - 1;
+    int step = ((m_preferSharps ? sharpLetter[pc] : flatLetter[pc]) - 2) + 7 * (oct - 4);
+
+    // fora da faixa visível: desloca por oitavas e marca 8va/15ma/8vb/15mb
+    int o = 0;
+    while (step > m_maxStep && o <  2) { step -= 7; ++o; }
+    while (step < m_minStep && o > -2) { step += 7; --o; }
+    *octaves = o;
+    return qBound(m_minStep, step, m_maxStep);
+}
+
+int NoteScrollWidget::colorIndex(double cents)
+{
+    const double a = std::abs(cents);
+    return a < 5.0 ? 0 : a < 15.0 ? 1 : a < 25.0 ? 2 : 3;
+}
+
+void NoteScrollWidget::paintColumns(int x0, int x1)
+{
+    QPainter p(&m_img);
+    const QRectF cols(x0 / m_dpr, 0, (x1 - x0) / m_dpr, m_stripRect.height());
+    p.setClipRect(cols);
+    p.fillRect(cols, m_colors.bg);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.setPen(QPen(m_colors.lines, 1.4));
+    for (int i = 0; i < 5; ++i) {
+        const qreal y = yForStep(2 * i);
+        p.drawLine(QPointF(cols.left(), y), QPointF(cols.right(), y));
+    }
+}
+
+void NoteScrollWidget::drawBar(const Note& n, qint64 fromMs, qint64 toMs, float cents)
+{
+    int oct = 0;
+    const qreal y  = yForStep(stepForMidi(n.midi, &oct));
+    const qreal x0 = qMax(xForMs(fromMs), xForMs(n.startMs) + m_head[0].width() / m_dpr);
+    const qreal x1 = xForMs(toMs);
+    if (x1 <= x0) return;
+
+    QPainter p(&m_img);
+    QColor c = kErrColor[colorIndex(cents)];
+    c.setAlpha(170);
+    p.fillRect(QRectF(x0, y - m_gap * 0.16, x1 - x0, m_gap * 0.32), c);
+}
+
+void NoteScrollWidget::stampNote(const Note& n, bool withMarks)
+{
+    int oct = 0;
+    const int step = stepForMidi(n.midi, &oct);
+    const qreal y  = yForStep(step);
+    const QImage& head = m_head[colorIndex(n.meanCents())];
+    const qreal hw = head.width() / m_dpr, hh = head.height() / m_dpr;
+    const qreal x  = xForMs(n.startMs);                   // borda esquerda da cabeça
+    if (x + hw < 0.0) return;
+
+    // sprites alinhados ao pixel do device: drawImage vira cópia
+    auto snap = [this](qreal v){ return qRound(v * m_dpr) / m_dpr; };
+    QPainter p(&m_img);
+
+    if (withMarks) {
+        // linhas suplementares (abaixo de E4 ou acima de F5)
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.setPen(QPen(m_colors.lines, 1.4, Qt::SolidLine, Qt::RoundCap));
+        const qreal xl = x - hw * 0.25, xr = x + hw * 1.25;
+        for (int s = -2; s >= step; s -= 2)
+            p.drawLine(QPointF(xl, yForStep(s)), QPointF(xr, yForStep(s)));
+        for (int s = 10; s <= step; s += 2)
+            p.drawLine(QPointF(xl, yForStep(s)), QPointF(xr, yForStep(s)));
+
+        static const bool black[12] = {false,true,false,true,false,false,
+                                       true,false,true,false,true,false};
+        if (black[n.midi % 12]) {
+            const QImage& acc = m_acc[m_preferSharps ? 0 : 1];
+            p.drawImage(QPointF(snap(x - acc.width() / m_dpr - m_gap * 0.1),
+                                snap(y - acc.height() / m_dpr / 2.0)), acc);
+        }
+        if (oct != 0) {
+            const QImage& mk = m_octave[(oct > 0 ? 0 : 2) + (std::abs(oct) - 1)];
+            const qreal my = oct > 0 ? y - m_gap * 1.2 - mk.height() / m_dpr : y + m_gap * 1.2;
+            p.drawImage(QPointF(snap(x), snap(my)), mk);
+        }
+    }
+    p.drawImage(QPointF(snap(x), snap(y - hh / 2.0)), head);
+}
+
+void NoteScrollWidget::buildSprites()
+{
+    auto blank = [this](QSizeF logical){
+        QImage img((logical * m_dpr).toSize().expandedTo(QSize(1, 1)),
+                   QImage::Format_ARGB32_Premultiplied);
+        img.setDevicePixelRatio(m_dpr);
+        img.fill(Qt::transparent);
+        return img;
+    };
+
+    // cabeças: oval inclinada como no StaffNoteWidget, uma por cor
+    const qreal d = m_gap * 1.1;
+    for (int i = 0; i < kColors; ++i) {
+        m_head[i] = blank(QSizeF(d * 1.5, d * 1.15));
+        QPainter p(&m_head[i]);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.translate(d * 0.75, d * 0.575);
+        p.rotate(-18);
+        p.setPen(QPen(m_colors.bg, 1.0));
+        p.setBrush(kErrColor[i]);
+        p.drawEllipse(QRectF(-d * 0.65, -d * 0.45, d * 1.3, d * 0.9));
+    }
+
+    auto text = [&](const QString& s, qreal pt, bool bold){
+        QFont f = font();
+        f.setBold(bold);
+        f.setPointSizeF(qMax(6.0, pt));
+        const QFontMetricsF fm(f);
+        QImage img = blank(QSizeF(fm.horizontalAdvance(s) + 2.0, fm.height()));
+        QPainter p(&img);
+        p.setFont(f);
+        p.setPen(m_colors.text);
+        p.drawText(QRectF(0, 0, img.width() / m_dpr, img.height() / m_dpr), Qt::AlignCenter, s);
+        return img;
+    };
+
+    // acidentes: símbolo musical se a fonte tiver o glifo, senão # / b
+    QFont af = font();
+    af.setPointSizeF(qMax(8.0, m_gap * 1.2));
+    const QFontMetricsF afm(af);
+    const bool glyphs = afm.horizontalAdvance(QString::fromUtf8("♯")) > 0.1
+                        && afm.horizontalAdvance(QString::fromUtf8("♭")) > 0.1;
+    m_acc[0] = text(glyphs ? QString::fromUtf8("♯") : QStringLiteral("#"), m_gap * 1.2, true);
+    m_acc[1] = text(glyphs ? QString::fromUtf8("♭") : QStringLiteral("b"), m_gap * 1.2, true);
+
+    static const char* marks[4] = {"8va", "15ma", "8vb", "15mb"};
+    for (int i = 0; i < 4; ++i)
+        m_octave[i] = text(QString::fromLatin1(marks[i]), m_gap * 0.7, false);
+}
+
+void NoteScrollWidget::rebuild()
+{
+    m_dpr = devicePixelRatioF();
+
+    // layout: clave à esquerda, pauta centrada com espaço p/ suplementares
+    const qreal gw = qBound<qreal>(36.0, height() * 0.42, width() * 0.25);
+    m_stripRect = QRectF(gw, 0, qMax<qreal>(0.0, width() - gw), height());
+    m_gap  = qBound(5.0, height() / 12.0, 22.0);
+    m_yE4  = height() / 2.0 + 2.0 * m_gap;
+    m_maxStep =  int(std::floor((m_yE4 - m_gap * 0.8) / (m_gap * 0.5)));
+    m_minStep = -int(std::floor((height() - m_gap * 0.8 - m_yE4) / (m_gap * 0.5)));
+    m_nowX = m_stripRect.width() - m_gap * 2.5;
+
+    // clave + começo das linhas (fixo)
+    m_gutter = QPixmap((QSizeF(gw, height()) * m_dpr).toSize().expandedTo(QSize(1, 1)));
+    m_gutter.setDevicePixelRatio(m_dpr);
+    m_gutter.fill(m_colors.bg);
+    {
+        QPainter g(&m_gutter);
+        g.setRenderHint(QPainter::Antialiasing, true);
+        g.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        g.setPen(QPen(m_colors.lines, 1.4));
+        for (int i = 0; i < 5; ++i)
+            g.drawLine(QPointF(gw * 0.1, yForStep(2 * i)), QPointF(gw, yForStep(2 * i)));
+        if (!m_clef.isNull()) {
+            const QRectF area(gw * 0.1, yForStep(8) - m_gap * 1.2, gw * 0.85, m_gap * 6.4);
+            const QSizeF img = m_clef.size() / m_clef.devicePixelRatio();
+            const qreal s = qMin(area.width() / img.width(), area.height() / img.height());
+            const QSizeF sz(img.width() * s, img.height() * s);
+            g.drawPixmap(QRectF(area.center() - QPointF(sz.width() / 2, sz.height() / 2), sz),
+                         m_clef, QRectF(QPointF(0, 0), img));
+        }
+    }
+
+    const QSize px = (m_stripRect.size() * m_dpr).toSize();
+    if (px.width() < 1 || px.height() < 1) { m_img = QImage(); return; }
+    m_img = QImage(px, QImage::Format_ARGB32_Premultiplied);
+    m_img.setDevicePixelRatio(m_dpr);
+    m_line.reanchor(m_dpr);
+    paintColumns(0, m_img.width());
+    buildSprites();
+
+    // replay do anel: só aqui a história inteira é redesenhada (a barra
+    // volta com a cor média da nota)
+    const quint32 first = m_count > quint32(kNotes) ? m_count - kNotes : 0;
+    for (quint32 i = first; i < m_count; ++i) {
+        const Note& n = m_notes[i & (kNotes - 1)];
+        const bool live = m_active && i == m_count - 1;
+        const qint64 end = live ? lineMs() : n.endMs;
+        if (xForMs(end) < -m_gap * 4.0) continue;
+        drawBar(n, n.startMs, end, live ? n.lastCents : float(n.meanCents()));
+        stampNote(n, true);
+        if (live) m_lastBarMs = end;
+    }
+}
+
+// ---------- eventos
+void NoteScrollWidget::paintEvent(QPaintEvent*)
+{
+    if (!qFuzzyCompare(devicePixelRatioF(), m_dpr)) rebuild();
+    QPainter p(this);
+    p.drawPixmap(0, 0, m_gutter);
+    if (!m_img.isNull()) p.drawImage(m_stripRect.topLeft(), m_img);
+    else p.fillRect(m_stripRect, m_colors.bg);
+}
+
+void NoteScrollWidget::resizeEvent(QResizeEvent* e)
+{
+    rebuild();
+    QWidget::resizeEvent(e);
+}
+
+void NoteScrollWidget::hideEvent(QHideEvent* e)
+{
+    pause();
+    QWidget::hideEvent(e);
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <QWidget>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+#include "scrollimage.h"
+
+// Pauta rolante com as notas que o músico tocou. As leituras do
+// PitchTracker (noteUpdate) viram eventos de nota — a mesma nota estável
+// por algumas leituras — guardados num anel fixo; a cabeça de cada nota
+// sai colorida pelo erro médio em cents e a nota sustentada vira uma barra
+// colorida pelo erro do momento (mostra o desvio ao longo da nota).
+//
+// Desenho incremental: a pauta vive numa QImage em pixels do device que a
+// cada frame é deslocada pelas colunas decorridas; só as colunas novas e a
+// nota em curso são desenhadas, com cabeças/acidentes em sprites prontos.
+// O custo por frame não depende de quantas notas há na tela; a imagem só é
+// refeita a partir do anel em resize/troca de DPR.
+class NoteScrollWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit NoteScrollWidget(QWidget* parent = nullptr);
+
+    void setPixelsPerSecond(double pps);  // velocidade da rolagem; default 60
+    void setPreferSharps(bool on);        // C♯ em vez de D♭ (default)
+    void setClefImage(const QPixmap& pm); // ":/sol.png"
+    void setColors(const QColor& bg, const QColor& lines, const QColor& text);
+    void clear();
+
+public slots:
+    // ligar em PitchTracker::noteUpdate
+    void addReading(int midi, double cents, double hz, double confidence);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void hideEvent(QHideEvent*) override;
+    QSize sizeHint() const override { return {560, 160}; }
+
+private:
+    struct Note {
+        int    midi     = 69;
+        qint64 startMs  = 0;             // tempo da linha (pausas descontadas)
+        qint64 endMs    = 0;
+        double centsSum = 0.0;
+        int    reads    = 0;
+        float  lastCents = 0.0f;
+        double meanCents() const { return reads ? centsSum / reads : 0.0; }
+    };
+
+    // segmentação das leituras
+    static constexpr double kMinConfidence = 0.5;
+    static constexpr int    kStableReads   = 3;   // leituras iguais p/ abrir nota (~100 ms)
+    static constexpr int    kGapReads      = 3;   // leituras ruins p/ fechar
+    static constexpr int    kNotes         = 512; // anel (potência de 2)
+    static constexpr int    kColors        = 4;   // faixas de erro das cabeças
+
+    void beginNote(int midi, qint64 startMs, qint64 nowMs, double centsSum, int reads, double cents);
+    void endNote();
+    Note& current() { return m_notes[(m_count - 1) & (kNotes - 1)]; }
+
+    // tempo / quadro
+    qint64 lineMs() const { return m_line.nowMs(); }
+    void   pause();                      // fecha a nota em curso e congela a linha
+    void   stepFrame();
+
+    // imagem
+    void   rebuild();                    // layout, sprites e replay do anel
+    void   buildSprites();
+    void   paintColumns(int x0, int x1); // fundo + linhas, px do device
+    void   stampNote(const Note& n, bool withMarks);
+    void   drawBar(const Note& n, qint64 fromMs, qint64 toMs, float cents);
+    qreal  xForMs(qint64 ms) const { return m_line.xForMs(ms, m_nowX); }
+    qreal  yForStep(int step) const;
+    int    stepForMidi(int midi, int* octaves) const;
+    static int colorIndex(double cents);
+
+    // notas
+    QVector<Note> m_notes;
+    quint32 m_count  = 0;                // total já aberto (o anel guarda kNotes)
+    bool    m_active = false;            // current() ainda soando
+    int     m_candMidi  = -1;
+    int     m_candReads = 0;
+    qint64  m_candStart = 0;
+    double  m_candSum   = 0.0;
+    int     m_misses    = 0;
+    qint64  m_lastBarMs = 0;
+
+    ScrollTimeline m_line;               // relógio, quadro e rolagem
+
+    // layout (lógico) e caches
+    QRectF  m_stripRect;
+    qreal   m_gap  = 10.0;               // distância entre linhas
+    qreal   m_yE4  = 0.0;                // linha inferior
+    qreal   m_nowX = 0.0;                // onde o "agora" fica na imagem
+    int     m_minStep = -6, m_maxStep = 14;
+    qreal   m_dpr  = 1.0;
+    QImage  m_img;                       // pauta rolante (px do device)
+    QPixmap m_gutter;                    // clave + começo das linhas
+    QPixmap m_clef;
+    QImage  m_head[kColors];
+    QImage  m_acc[2];                    // ♯ / ♭ (ou # / b)
+    QImage  m_octave[4];                 // 8va 15ma 8vb 15mb
+    bool    m_preferSharps = true;
+
+    StripColors m_colors;
+};
@@ -0,0 +1,184 @@
+#include "pitchhistorywidget.h"
+#include "scrollimage.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFontMetricsF>
+#include <QtMath>
+#include <cmath>
+
+PitchHistoryWidget::PitchHistoryWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent, true);
+    setAutoFillBackground(false);
+    setMinimumHeight(70);
+
+    m_samples.resize(kSamples);
+    m_line.setPxPerMs(0.04);
+    connect(m_line.frameTimer(), &QTimer::timeout, this, &PitchHistoryWidget::stepFrame);
+}
+
+void PitchHistoryWidget::setSpanSeconds(int s)
+{
+    m_spanS = qBound(10, s, 30);
+    rebuild();
+    update();
+}
+
+void PitchHistoryWidget::setColors(const QColor& bg, const QColor& grid, const QColor& text)
+{
+    m_colors = {bg, grid, text};
+    rebuild();
+    update();
+}
+
+void PitchHistoryWidget::clear()
+{
+    m_count = 0;
+    rebuild();
+    update();
+}
+
+void PitchHistoryWidget::addReading(int midi, double cents, double hz, double confidence)
+{
+    Q_UNUSED(midi);
+    m_line.reading(isVisible(), screen());
+
+    Sample& s = m_samples[m_count & (kSamples - 1)];
+    ++m_count;
+    s.ms    = lineMs();
+    s.cents = float(qBound(-50.0, cents, 50.0));
+    s.conf  = hz > 0.0 ? float(qBound(0.0, confidence, 1.0)) : 0.0f;
+
+    // rola até agora antes de plotar: o segmento novo cai em colunas que
+    // já estão na imagem e não é apagado pelo próximo frame
+    if (m_count > 1 && !m_img.isNull() && !m_line.isPaused()) {
+        stepFrame();
+        plot(m_samples[(m_count - 2) & (kSamples - 1)], s);
+        update(m_plotRect.toAlignedRect());
+    }
+}
+
+// ---------- tempo
+void PitchHistoryWidget::stepFrame()
+{
+    if (m_line.idle()) { m_line.pause(); return; }
+    if (m_img.isNull()) return;
+    if (m_line.scroll(m_img, [this](int x0, int x1){ paintColumns(x0, x1); }) > 0)
+        update(m_plotRect.toAlignedRect());
+}
+
+// ---------- imagem
+qreal PitchHistoryWidget::yForCents(double c) const
+{
+    const qreal h = m_plotRect.height() - m_confH;
+    return h * 0.5 - c / 50.0 * (h * 0.5 - 2.0);
+}
+
+void PitchHistoryWidget::paintColumns(int x0, int x1)
+{
+    QPainter p(&m_img);
+    const QRectF cols(x0 / m_dpr, 0, (x1 - x0) / m_dpr, m_plotRect.height());
+    p.setClipRect(cols);
+    p.fillRect(cols, m_colors.bg);
+
+    // faixa segura ±5, grade em ±10/±25 e linha do zero
+    QColor safe = m_safe; safe.setAlpha(45);
+    p.fillRect(QRectF(cols.left(), yForCents(5.0), cols.width(),
+                      yForCents(-5.0) - yForCents(5.0)), safe);
+    p.setPen(QPen(m_colors.lines, 1.0));
+    for (double c : {-25.0, -10.0, 10.0, 25.0})
+        p.drawLine(QPointF(cols.left(), yForCents(c)), QPointF(cols.right(), yForCents(c)));
+    p.setPen(QPen(m_colors.lines.lighter(150), 1.0));
+    p.drawLine(QPointF(cols.left(), yForCents(0.0)), QPointF(cols.right(), yForCents(0.0)));
+    p.drawLine(QPointF(cols.left(), m_plotRect.height() - m_confH),
+               QPointF(cols.right(), m_plotRect.height() - m_confH));
+}
+
+void PitchHistoryWidget::plot(const Sample& a, const Sample& b)
+{
+    const qreal xb = xForMs(b.ms);
+    const qreal xa = xForMs(qMax(a.ms, b.ms - 200));   // depois de pausa: só um passo
+    if (xb < 0.0 || xb <= xa) return;
+    QPainter p(&m_img);
+
+    // confiança: barra embaixo, do instante anterior até esta leitura
+    if (b.conf > 0.0f) {
+        const qreal h = m_confH * b.conf;
+        p.fillRect(QRectF(xa, m_plotRect.height() - h, xb - xa, h), m_conf);
+    }
+
+    // cents: só liga leituras seguidas e confiáveis (silêncio quebra a linha)
+    if (a.conf <= 0.0f || b.conf <= 0.0f || b.ms - a.ms > 200) return;
+    QColor c = m_trace;
+    c.setAlphaF(0.25 + 0.75 * qMin(a.conf, b.conf));
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.setPen(QPen(c, 1.6, Qt::SolidLine, Qt::RoundCap));
+    p.drawLine(QPointF(xa, yForCents(a.cents)), QPointF(xb, yForCents(b.cents)));
+}
+
+void PitchHistoryWidget::rebuild()
+{
+    m_dpr = devicePixelRatioF();
+
+    // rótulos à esquerda, gráfico no resto
+    QFont f = font();
+    f.setPointSizeF(qMax(7.0, height() * 0.07));
+    const QFontMetricsF fm(f);
+    const qreal aw = fm.horizontalAdvance(QStringLiteral("+50")) + 6.0;
+    m_plotRect = QRectF(aw, 0, qMax<qreal>(0.0, width() - aw), height());
+    m_confH    = qMax<qreal>(6.0, height() * 0.14);
+    m_line.setPxPerMs(m_plotRect.width() / (m_spanS * 1000.0));
+
+    m_axis = QPixmap((QSizeF(aw, height()) * m_dpr).toSize().expandedTo(QSize(1, 1)));
+    m_axis.setDevicePixelRatio(m_dpr);
+    m_axis.fill(m_colors.bg);
+    {
+        QPainter g(&m_axis);
+        g.setFont(f);
+        g.setPen(m_colors.text);
+        for (int c : {50, 25, 0, -25, -50}) {
+            const QRectF box(0, yForCents(c) - fm.height() / 2.0, aw - 4.0, fm.height());
+            g.drawText(box, Qt::AlignRight | Qt::AlignVCenter,
+                       c > 0 ? QStringLiteral("+%1").arg(c) : QString::number(c));
+        }
+    }
+
+    const QSize px = (m_plotRect.size() * m_dpr).toSize();
+    if (px.width() < 1 || px.height() < 1) { m_img = QImage(); return; }
+    m_img = QImage(px, QImage::Format_ARGB32_Premultiplied);
+    m_img.setDevicePixelRatio(m_dpr);
+    m_line.reanchor(m_dpr);
+    paintColumns(0, m_img.width());
+
+    // replay do anel (só aqui a história é replotada)
+    const qint64 from = lineMs() - qint64(m_spanS) * 1000;
+    const quint32 first = m_count > quint32(kSamples) ? m_count - kSamples : 0;
+    for (quint32 i = first + 1; i < m_count; ++i) {
+        const Sample& b = m_samples[i & (kSamples - 1)];
+        if (b.ms < from) continue;
+        plot(m_samples[(i - 1) & (kSamples - 1)], b);
+    }
+}
+
+// ---------- eventos
+void PitchHistoryWidget::paintEvent(QPaintEvent*)
+{
+    if (!qFuzzyCompare(devicePixelRatioF(), m_dpr)) rebuild();
+    QPainter p(this);
+    p.drawPixmap(0, 0, m_axis);
+    if (!m_img.isNull()) p.drawImage(m_plotRect.topLeft(), m_img);
+    else p.fillRect(m_plotRect, m_colors.bg);
+}
+
+void PitchHistoryWidget::resizeEvent(QResizeEvent* e)
+{
+    rebuild();
+    QWidget::resizeEvent(e);
+}
+
+void PitchHistoryWidget::hideEvent(QHideEvent* e)
+{
+    m_line.pause();
+    QWidget::hideEvent(e);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <QWidget>
+#include <QImage>
+#include <QPixmap>
+#include <QVector>
+#include "scrollimage.h"
+
+// Gráfico de rolagem dos cents (e da confiança) dos últimos segundos: mostra
+// deriva e vibrato numa nota sustentada. Alimentado por
+// PitchTracker::noteUpdate num anel de tamanho fixo.
+//
+// O gráfico é uma QImage em pixels do device deslocada no lugar pelas
+// colunas decorridas; cada frame só pinta o fundo das colunas novas e os
+// segmentos das leituras novas — a história nunca é replotada, exceto em
+// resize/troca de DPR (replay do anel).
+class PitchHistoryWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PitchHistoryWidget(QWidget* parent = nullptr);
+
+    void setSpanSeconds(int s);          // 10..30, default 15
+    int  spanSeconds() const { return m_spanS; }
+    void setColors(const QColor& bg, const QColor& grid, const QColor& text);
+    void clear();
+
+public slots:
+    // ligar em PitchTracker::noteUpdate
+    void addReading(int midi, double cents, double hz, double confidence);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void hideEvent(QHideEvent*) override;
+    QSize sizeHint() const override { return {560, 110}; }
+
+private:
+    struct Sample {
+        qint64 ms    = 0;                // tempo da linha (pausas descontadas)
+        float  cents = 0.0f;
+        float  conf  = 0.0f;             // 0 = sem leitura (silêncio)
+    };
+    static constexpr int kSamples = 1024;   // > 30 s a ~35 ms por leitura
+
+    qint64 lineMs() const { return m_line.nowMs(); }
+    void   stepFrame();
+
+    void   rebuild();
+    void   paintColumns(int x0, int x1); // fundo + grade, px do device
+    void   plot(const Sample& a, const Sample& b);   // segmento a -> b
+    qreal  xForMs(qint64 ms) const { return m_line.xForMs(ms, m_plotRect.width()); }
+    qreal  yForCents(double c) const;
+
+    // anel
+    QVector<Sample> m_samples;
+    quint32 m_count = 0;
+
+    ScrollTimeline m_line;               // relógio, quadro e rolagem
+    int     m_spanS     = 15;
+
+    // layout (lógico) e caches
+    QRectF  m_plotRect;
+    qreal   m_confH = 0.0;               // faixa da confiança (embaixo)
+    qreal   m_dpr   = 1.0;
+    QImage  m_img;
+    QPixmap m_axis;                      // rótulos dos cents (fixo)
+
+    StripColors m_colors;                // fundo, grade, rótulos
+    QColor  m_safe  = QColor(0x22, 0x8b, 0x22);
+    QColor  m_trace = QColor(0x4f, 0x8a, 0xff);
+    QColor  m_conf  = QColor("#6A6A70");
+};
@@ -1,91 +1,169 @@
 #include "PitchTracker.h"
+#include "audioengine.h"
+#include "spscqueue.h"
 
-#include <QMediaDevices>
-#include <QAudioDevice>
-#include <QAudioSource>
 #include <QtMath>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
 #include <QDebug>
 
+// ----------------- entrada (thread de áudio) -----------------
+// Recebe os frames carimbados do AudioEngine e os passa à GUI em blocos
+// por uma fila sem lock; a análise continua na GUI, no ritmo do timer.
+class PitchTracker::InputTap : public AudioInput
+{
+public:
+    static constexpr int kFrames = 512;
+    struct Block {
+        qint64 clock    = 0;               // relógio comum do 1º frame
+        int    frames   = 0;
+        bool   hasRef   = false;           // o app tocava algo nestes samples
+        bool   hasOnset = false;           // algum click começa no bloco
+        float  data[kFrames];
+        float  ref[kFrames];
+        quint8 onset[kFrames];
+    };
+
+    void prepare(int sampleRate) override { m_sr = sampleRate; }
+    int  sampleRate() const { return m_sr; }
+
+    void capture(const float* in, int frames, qint64 clock, const AudioRef* ref) override
+    {
+        for (int done = 0; done < frames; ) {
+            Block b;
+            b.frames = qMin(kFrames, frames - done);
+            b.clock  = clock + done;
+            std::copy(in + done, in + done + b.frames, b.data);
+            if (ref && ref->signal) {
+                b.hasRef = true;
+                std::copy(ref->signal + done, ref->signal + done + b.frames, b.ref);
+            }
+            if (ref && ref->transient) {
+                const quint8* t = ref->transient + done;
+                b.hasOnset = std::find(t, t + b.frames, quint8(1)) != t + b.frames;
+                if (b.hasOnset) std::copy(t, t + b.frames, b.onset);
+            }
+            if (!m_queue.push(b)) m_dropped.fetch_add(1, std::memory_order_relaxed);
+            done += b.frames;
+        }
+    }
+
+    bool pop(Block& b) { return m_queue.pop(b); }
+    quint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    SpscQueue<Block, 64> m_queue;         // ~0,7 s a 48 kHz
+    std::atomic<quint64> m_dropped {0};
+    int m_sr = 48000;
+};
+
 PitchTracker::PitchTracker(QObject* parent)
     : QObject(parent)
 {
-    // Não definimos device/format aqui para não depender de permissão;
-    // fazemos isso em start().
+    // O microfone só é aberto em start() (depende de permissão).
     m_fifo.reserve(m_sampleRate); // ~1s
+    m_tap = new InputTap;
+    connect(&m_poll, &QTimer::timeout, this, &PitchTracker::pollInput);
 }
 
 PitchTracker::~PitchTracker()
 {
     stop();
-    if (m_source) {
-        m_source->deleteLater();
-        m_source = nullptr;
-    }
+    delete m_tap;
+    m_tap = nullptr;
 }
 
 // ----------------- Config -----------------
 void PitchTracker::setMinFrequency(double hz)   { m_minF = std::max(10.0, hz); }
 void PitchTracker::setMaxFrequency(double hz)   { m_maxF = std::max(20.0, hz); }
 void PitchTracker::setAnalysisSize(int samples) { m_analysisSize = std::max(1024, samples); }
-void PitchTracker::setProcessIntervalMs(int ms) { m_processInterval = std::max(10, ms); }
+void PitchTracker::setProcessIntervalMs(int ms) {
+    m_processInterval = std::max(10, ms);
+    m_poll.setInterval(m_processInterval);
+}
 void PitchTracker::setSilenceRmsThreshold(double t) {
     m_silenceThresh = std::max(0.0, std::min(0.1, t));
 }
 
-// ----------------- Start/Stop -----------------
-bool PitchTracker::start()
+void PitchTracker::setRejectFrequencies(const QVector<double>& hz)
 {
-    if (m_running) return true;
-
-    // (Re)descobre o dispositivo e o formato AGORA (perm já concedida)
-    QAudioDevice dev = QMediaDevices::defaultAudioInput();
-    if (!dev.isNull()) {
-        QAudioFormat want;
-        want.setSampleRate(m_sampleRate);
-        want.setChannelCount(1);
-        want.setSampleFormat(QAudioFormat::Int16);
-
-        if (dev.isFormatSupported(want)) {
-            m_fmt = want;
-        } else {
-            m_fmt = dev.preferredFormat();
-            m_sampleRate = m_fmt.sampleRate();
-            m_channels   = m_fmt.channelCount();
-        }
-    } else {
-        // fallback sensato
-        m_fmt.setSampleRate(m_sampleRate);
-        m_fmt.setChannelCount(1);
-        m_fmt.setSampleFormat(QAudioFormat::Int16);
+    if (hz == m_notchHz) return;
+    m_notchHz = hz;
+    m_notches.clear();
+
+    // notch RBJ estreito (Q 40 ≈ ±20 cents em 440 Hz): só o drone some;
+    // uma nota tocada em uníssono ainda aparece pelos harmônicos
+    const double q = 40.0;
+    for (int i = 0; i < hz.size() && i < 4; ++i) {
+        const double f = hz[i];
+        if (f <= 0.0 || f >= 0.45 * m_sampleRate) continue;
+        const double w0 = 2.0 * M_PI * f / m_sampleRate;
+        const double alpha = std::sin(w0) / (2.0 * q);
+        const double a0 = 1.0 + alpha;
+        Notch n;
+        n.b0 = float(1.0 / a0);
+        n.b1 = float(-2.0 * std::cos(w0) / a0);
+        n.b2 = n.b0;
+        n.a1 = n.b1;
+        n.a2 = float((1.0 - alpha) / a0);
+        m_notches.append(n);
     }
+}
 
-    // Sempre recrie a fonte para garantir estado limpo
-    if (m_source) {
-        m_source->stop();
-        m_source->deleteLater();
-        m_source = nullptr;
-    }
-    m_source = new QAudioSource(dev, m_fmt, this);
+void PitchTracker::setSpectrumEnabled(bool on, int bands)
+{
+    m_spectrumOn    = on;
+    m_spectrumBands = std::max(16, std::min(512, bands));
+}
 
-    // Latência moderada (resposta estável p/ afinador)
-    m_source->setBufferSize(std::max(4096, m_sampleRate / 10)); // ~100 ms
+void PitchTracker::setClickMaskMs(int ms) { m_clickMaskMs = std::max(0, std::min(500, ms)); }
 
-    m_io = m_source->start();
-    if (!m_io) {
-        qWarning() << "[PitchTracker] start() failed: QAudioSource::start() returned nullptr";
-        return false;
-    }
+void PitchTracker::setEchoCancellation(bool on, double pathDelayMs)
+{
+    m_echoOn = on;
+    m_echoDelayMs = std::max(0.0, pathDelayMs);
+    m_echoW.fill(0.0f, 128);
+    m_echoHist.fill(0.0f, 8192);
+    m_echoPos  = 0;
+    m_echoIdle = 1 << 30;
+    m_echoPow  = 0.0f;
+}
 
-    connect(m_io, &QIODevice::readyRead, this, &PitchTracker::onReadyRead, Qt::UniqueConnection);
+// ----------------- Start/Stop -----------------
+bool PitchTracker::start()
+{
+    if (m_running) return true;
 
-    m_timer.restart();
+    // Entrada duplex do AudioEngine: microfone aberto junto com a saída
+    // (perm já concedida), frames carimbados no relógio do drone/metrônomo.
+    AudioEngine& ae = AudioEngine::shared();
+    if (!ae.addInput(m_tap)) {
+        qWarning() << "[PitchTracker] start() failed: entrada do AudioEngine indisponivel";
+        return false;
+    }
+    m_sampleRate = m_tap->sampleRate();
+
+    InputTap::Block stale;
+    while (m_tap->pop(stale)) {}
+    m_fifo.clear();
+    m_fifoEndClock = 0;
+
+    // filtros recomeçam do zero (taxa pode ter mudado)
+    const QVector<double> notchHz = m_notchHz;
+    m_notchHz.clear();
+    setRejectFrequencies(notchHz);
+    if (m_echoOn) setEchoCancellation(true, m_echoDelayMs);
+    m_maskHold = 0;
+    m_lastMaskedClock = -(qint64(1) << 60);
+    m_lastOnsetClock  = -(qint64(1) << 60);
+    m_lastAnalysisClock = 0;
+
+    m_poll.start(m_processInterval);
     m_running = true;
     emit started();
 
-    qInfo() << "[PitchTracker] started at" << m_fmt.sampleRate() << "Hz,"
-            << m_fmt.channelCount() << "ch, sf=" << int(m_fmt.sampleFormat());
+    qInfo() << "[PitchTracker] started at" << m_sampleRate << "Hz (duplex, relogio comum)";
     return true;
 }
 
@@ -93,99 +171,101 @@ void PitchTracker::stop()
 {
     if (!m_running) return;
 
-    if (m_io) {
-        disconnect(m_io, nullptr, this, nullptr);
-        m_io = nullptr;
-    }
-    if (m_source) {
-        m_source->stop();
-        // não deletamos já — deixamos para o próximo start recriar limpo
-        // (mas garantimos que o ponteiro seja destruído no dtor)
-    }
+    m_poll.stop();
+    AudioEngine::shared().removeInput(m_tap);    // espera o callback largar o tap
     m_running = false;
     emit stopped();
-    qInfo() << "[PitchTracker] stopped";
+    qInfo() << "[PitchTracker] stopped; blocos perdidos:" << m_tap->dropped();
 }
 
 // ----------------- Audio fluxo -----------------
-void PitchTracker::onReadyRead()
+void PitchTracker::pollInput()
 {
-    if (!m_io) return;
-    const qint64 avail = m_io->bytesAvailable();
-    if (avail <= 0) return;
-
-    QByteArray chunk;
-    chunk.resize(int(avail));
-    const qint64 read = m_io->read(chunk.data(), chunk.size());
-    if (read <= 0) return;
-
-    pushSamplesFromBytes(chunk.constData(), int(read));
+    InputTap::Block b;
+    bool any = false;
+    while (m_tap->pop(b)) {
+        rejectSelfOutput(b.data, b.hasRef ? b.ref : nullptr, b.hasOnset ? b.onset : nullptr,
+                         b.frames, b.clock);
+        m_fifo.insert(m_fifo.end(), b.data, b.data + b.frames);
+        m_fifoEndClock = b.clock + b.frames;
+        any = true;
+    }
+    if (!any) return;
 
-    // Processa no máximo a cada m_processInterval ms
-    if (m_timer.elapsed() >= m_processInterval) {
-        processAnalysis();
-        m_timer.restart();
+    const int maxKeep = std::max(m_sampleRate + m_analysisSize, m_sampleRate * 3 / 2);
+    if (m_fifo.size() > maxKeep) {
+        const int drop = m_fifo.size() - maxKeep;
+        m_fifo.erase(m_fifo.begin(), m_fifo.begin() + drop);
     }
+
+    processAnalysis();
 }
 
-void PitchTracker::pushSamplesFromBytes(const char* data, int bytes)
+// ----------------- Rejeição do próprio som -----------------
+void PitchTracker::rejectSelfOutput(float* x, const float* ref, const quint8* onset,
+                                    int n, qint64 clock)
 {
-    const int ch = m_fmt.channelCount();
-
-    switch (m_fmt.sampleFormat()) {
-    case QAudioFormat::Int16: {
-        const qint16* p = reinterpret_cast<const qint16*>(data);
-        const int frames = bytes / (int(sizeof(qint16)) * ch);
-        for (int i=0; i<frames; ++i) {
-            float s = 0.f;
-            for (int c=0; c<ch; ++c)
-                s += p[i*ch + c] / 32768.f;
-            m_fifo.push_back(s / float(ch));
+    // 1) eco: subtrai o mix do app (precisa do sinal cru do microfone)
+    if (m_echoOn) cancelEcho(x, ref, n);
+
+    // 2) drones: cascata de notches
+    for (Notch& f : m_notches) {
+        for (int i = 0; i < n; ++i) {
+            const float in  = x[i];
+            const float out = f.b0 * in + f.z1;
+            f.z1 = f.b1 * in - f.a1 * out + f.z2;
+            f.z2 = f.b2 * in - f.a2 * out;
+            x[i] = out;
         }
-        break;
     }
-    case QAudioFormat::Int32: {
-        const qint32* p = reinterpret_cast<const qint32*>(data);
-        const int frames = bytes / (int(sizeof(qint32)) * ch);
-        for (int i=0; i<frames; ++i) {
-            float s = 0.f;
-            for (int c=0; c<ch; ++c)
-                s += p[i*ch + c] / 2147483648.0f; // 2^31
-            m_fifo.push_back(s / float(ch));
-        }
-        break;
-    }
-    case QAudioFormat::Float: {
-        const float* p = reinterpret_cast<const float*>(data);
-        const int frames = bytes / (int(sizeof(float)) * ch);
-        for (int i=0; i<frames; ++i) {
-            float s = 0.f;
-            for (int c=0; c<ch; ++c)
-                s += p[i*ch + c];
-            m_fifo.push_back(s / float(ch));
-        }
-        break;
-    }
-    case QAudioFormat::UInt8: { // 8-bit unsigned (raro, mas existe)
-        const quint8* p = reinterpret_cast<const quint8*>(data);
-        const int frames = bytes / (int(sizeof(quint8)) * ch);
-        for (int i=0; i<frames; ++i) {
-            float s = 0.f;
-            for (int c=0; c<ch; ++c)
-                s += (float(p[i*ch + c]) - 128.f) / 128.f; // 0..255 -> -1..1
-            m_fifo.push_back(s / float(ch));
+
+    // 3) clicks: silencia do início de cada click até o fim do decaimento
+    //    (inclui a latência saída -> ar -> microfone); com clicks densos
+    //    (semicolcheias rápidas, camadas) a máscara cobre no máximo metade
+    //    do intervalo entre eles, senão o afinador nunca ouve nada
+    if (!onset && m_maskHold <= 0) return;
+    const int hold = m_sampleRate * m_clickMaskMs / 1000;
+    for (int i = 0; i < n; ++i) {
+        if (onset && onset[i]) {
+            const qint64 gap = clock + i - m_lastOnsetClock;
+            m_maskHold = int(std::min<qint64>(hold, gap / 2));
+            m_lastOnsetClock = clock + i;
         }
-        break;
-    }
-    default:
-        // formato não suportado: ignora o chunk
-        break;
+        if (m_maskHold <= 0) continue;
+        x[i] = 0.0f;
+        --m_maskHold;
+        m_lastMaskedClock = clock + i;
     }
+}
 
-    const int maxKeep = std::max(m_sampleRate + m_analysisSize, m_sampleRate * 3 / 2);
-    if (m_fifo.size() > maxKeep) {
-        const int drop = m_fifo.size() - maxKeep;
-        m_fifo.erase(m_fifo.begin(), m_fifo.begin() + drop);
+void PitchTracker::cancelEcho(float* x, const float* ref, int n)
+{
+    // NLMS de 128 taps sobre a referência atrasada pelo caminho acústico;
+    // parado depois que a referência some por mais que o histórico
+    const int hist = m_echoHist.size();
+    const int taps = m_echoW.size();
+    if (ref) m_echoIdle = 0;
+    else if ((m_echoIdle += n) > hist) return;
+
+    const int mask  = hist - 1;
+    const int delay = std::min(hist - taps - 1, int(m_echoDelayMs * m_sampleRate / 1000.0));
+    const float mu  = 0.2f;
+    float* h = m_echoHist.data();
+    float* w = m_echoW.data();
+    for (int i = 0; i < n; ++i) {
+        h[m_echoPos & mask] = ref ? ref[i] : 0.0f;
+        const int base = m_echoPos - delay;
+        const float rNew = h[base & mask];
+        const float rOld = h[(base - taps) & mask];
+        m_echoPow = std::max(0.0f, m_echoPow + rNew * rNew - rOld * rOld);
+
+        float y = 0.0f;
+        for (int k = 0; k < taps; ++k) y += w[k] * h[(base - k) & mask];
+        const float e = x[i] - y;
+        const float g = mu * e / (m_echoPow + 1.0e-6f);
+        for (int k = 0; k < taps; ++k) w[k] += g * h[(base - k) & mask];
+        x[i] = e;
+        m_echoPos = (m_echoPos + 1) & mask;
     }
 }
 
@@ -194,15 +274,24 @@ void PitchTracker::processAnalysis()
 {
     if (m_fifo.size() < m_analysisSize) return;
 
+    // click dentro da metade mais nova da janela: mantém a leitura anterior,
+    // mas só por kMaxHoldMs — depois analisa mesmo assim (trechos mascarados
+    // são zeros) para a UI não congelar sem leituras
+    if (m_fifoEndClock - m_lastMaskedClock < m_analysisSize / 2
+        && m_fifoEndClock - m_lastAnalysisClock < qint64(m_sampleRate) * kMaxHoldMs / 1000)
+        return;
+    m_lastAnalysisClock = m_fifoEndClock;
+
     // janela mais recente
     const int N = m_analysisSize;
     const int start = m_fifo.size() - N;
-    QVector<float> x(N);
-    std::copy(m_fifo.constBegin() + start, m_fifo.constBegin() + start + N, x.begin());
+    m_frame.resize(N);
+    float* x = m_frame.data();
+    std::copy(m_fifo.constBegin() + start, m_fifo.constBegin() + start + N, x);
 
     // remove DC + Hann
     double mean = 0.0;
-    for (float v : x) mean += v;
+    for (int i=0; i<N; ++i) mean += x[i];
     mean /= double(N);
     for (int i=0; i<N; ++i) {
         x[i] = float(x[i] - mean);
@@ -210,9 +299,17 @@ void PitchTracker::processAnalysis()
         x[i] *= float(w);
     }
 
+    // espectro do mesmo quadro (também no silêncio: mostra o ruído de fundo)
+    if (m_spectrumOn) {
+        if (!m_spectrum.isPreparedFor(N, m_sampleRate, m_spectrumBands))
+            m_spectrum.prepare(N, m_sampleRate, 40.0, 8000.0, m_spectrumBands);
+        m_spectrum.process(x, float(N - 1) * 0.5f);   // soma da Hann
+        emit spectrumUpdated(m_spectrum.bandsDb(), m_spectrum.minHz(), m_spectrum.maxHz());
+    }
+
     // silêncio?
     double rms = 0.0;
-    for (float v : x) rms += double(v) * double(v);
+    for (int i=0; i<N; ++i) rms += double(x[i]) * double(x[i]);
     rms = std::sqrt(rms / double(N));
     if (rms < m_silenceThresh) {
         emit pitchFrequency(0.0, 0.0);
@@ -221,7 +318,7 @@ void PitchTracker::processAnalysis()
     }
 
     double conf = 0.0;
-    const double f0 = detectPitchACF(x.constData(), N, m_sampleRate, m_minF, m_maxF, &conf);
+    const double f0 = detectPitchACF(x, N, m_sampleRate, m_minF, m_maxF, &conf);
 
     if (f0 > 0.0) {
         const int midi = freqToMidi(f0);
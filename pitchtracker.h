@@ -1,11 +1,10 @@
 #pragma once
 
 #include <QObject>
-#include <QAudioSource>
-#include <QAudioFormat>
-#include <QIODevice>
+#include <QTimer>
 #include <QVector>
-#include <QElapsedTimer>
+#include <cmath>
+#include "spectrum.h"
 
 class PitchTracker : public QObject
 {
@@ -21,9 +20,23 @@ public:
     void setProcessIntervalMs(int ms);   // throttling; default: ~40 ms
     void setSilenceRmsThreshold(double t); // 0..1 (escala float), default: 0.005
 
+    // Relógio comum do AudioEngine no sample mais novo analisado (mesma
+    // escala dos samples da saída: drone/metrônomo)
+    qint64 lastClock() const { return m_fifoEndClock; }
+
+    // Rejeição do som do próprio app. Nada disso custa por frame quando o
+    // app está em silêncio.
+    void setRejectFrequencies(const QVector<double>& hz); // notch em cada drone (até 4)
+    void setClickMaskMs(int ms);         // silencia a entrada após cada click; default: 70 ms (até metade do intervalo entre clicks)
+    void setEchoCancellation(bool on, double pathDelayMs = 0.0); // NLMS sobre o mix; default: off
+
+    // Espectro do mesmo quadro janelado da análise (para diagnóstico).
+    // Desligado não custa nada; ligue só com a vista na tela.
+    void setSpectrumEnabled(bool on, int bands = 128);
+
 public slots:
-    bool start();   // inicia microfone; retorna false se falhar
-    void stop();    // para microfone
+    bool start();   // entra na entrada do AudioEngine; false se falhar
+    void stop();    // sai da entrada
 
 signals:
     void started();
@@ -35,16 +48,22 @@ signals:
     // Emite nota + cents relativos à nota mais próxima ([-50,+50]) + Hz + confiança
     void noteUpdate(int midi, double cents, double hz, double confidence);
 
+    // Bandas log de minHz a maxHz em dBFS (vetor reaproveitado: copie se
+    // precisar guardar)
+    void spectrumUpdated(const QVector<float>& bandsDb, double minHz, double maxHz);
+
 private slots:
-    void onReadyRead();
+    void pollInput();
 
 private:
-    // Conversão de PCM para float e enfileiramento
-    void pushSamplesFromBytes(const char* data, int bytes);
 
     // Processa último bloco (analysisSize) e emite sinais
     void processAnalysis();
 
+    // Tira da entrada o que o próprio app tocou (ref/onset nulos = nada)
+    void rejectSelfOutput(float* x, const float* ref, const quint8* onset, int n, qint64 clock);
+    void cancelEcho(float* x, const float* ref, int n);
+
     // Detecção de pitch por autocorrelação (com interp. parabólica)
     // Retorna Hz; *conf retorna medida simples de confiança (pico/R0)
     double detectPitchACF(const float* x, int N, int sr,
@@ -63,24 +82,50 @@ private:
     }
 
 private:
-    // Áudio
-    QAudioSource*  m_source = nullptr;
-    QIODevice*     m_io     = nullptr;
-    QAudioFormat   m_fmt;
+    // Áudio: consumidor da entrada do AudioEngine (thread de áudio -> GUI)
+    class InputTap;
+    InputTap*      m_tap = nullptr;
 
     // Buffer FIFO de áudio em float mono
     QVector<float> m_fifo;
+    QVector<float> m_frame;              // janela da análise (reaproveitada)
+    qint64         m_fifoEndClock = 0;   // relógio comum após o último sample
 
     // Parâmetros
     int     m_sampleRate       = 48000;
-    int     m_channels         = 1;
     int     m_analysisSize     = 4096;
     double  m_minF             = 60.0;
     double  m_maxF             = 1200.0;
     int     m_processInterval  = 40;     // ms
     double  m_silenceThresh    = 0.005;  // RMS (float 0..1)
 
+    // Rejeição do próprio som
+    struct Notch {
+        float b0 = 1, b1 = 0, b2 = 1, a1 = 0, a2 = 0;
+        float z1 = 0, z2 = 0;
+    };
+    QVector<Notch> m_notches;
+    QVector<double> m_notchHz;
+    int     m_clickMaskMs      = 70;
+    int     m_maskHold         = 0;      // frames ainda mascarados
+    qint64  m_lastMaskedClock  = -(qint64(1) << 60);
+    qint64  m_lastOnsetClock   = -(qint64(1) << 60);
+    qint64  m_lastAnalysisClock = 0;     // fim da janela da última análise
+    static constexpr int kMaxHoldMs = 150; // sem análise por causa de clicks, no máximo
+    bool    m_echoOn           = false;
+    double  m_echoDelayMs      = 0.0;
+    QVector<float> m_echoW;              // coeficientes do NLMS
+    QVector<float> m_echoHist;           // histórico da referência
+    int     m_echoPos          = 0;
+    int     m_echoIdle         = 1 << 30; // frames desde a última referência
+    float   m_echoPow          = 0.0f;   // energia da referência na janela
+
+    // Espectro
+    bool     m_spectrumOn    = false;
+    int      m_spectrumBands = 128;
+    Spectrum m_spectrum;
+
     // Controle
-    QElapsedTimer m_timer;
+    QTimer  m_poll;
     bool    m_running = false;
 };
@@ -0,0 +1,114 @@
+#pragma once
+#include <QColor>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QScreen>
+#include <QTimer>
+#include <cmath>
+#include <cstring>
+
+// Desloca o conteúdo de `img` dx pixels (do device) para a esquerda, no
+// lugar, sem alocar. As dx colunas da direita ficam com o conteúdo antigo e
+// devem ser repintadas por quem chamou. dx >= largura não faz nada: quem
+// chamou repinta tudo.
+inline void scrollImageLeft(QImage& img, int dx)
+{
+    if (dx <= 0 || dx >= img.width()) return;
+    const int bpp  = img.depth() / 8;
+    const size_t keep = size_t(img.width() - dx) * size_t(bpp);
+    for (int y = 0; y < img.height(); ++y) {
+        uchar* row = img.scanLine(y);
+        std::memmove(row, row + dx * bpp, keep);
+    }
+}
+
+// Linha do tempo das faixas rolantes sob o afinador (pauta de notas e
+// histórico de cents): relógio que congela quando as leituras param (sem
+// buraco na volta), timer de quadro no ritmo da tela e a contabilidade da
+// rolagem — px do device já rolados desde a âncora da imagem.
+class ScrollTimeline
+{
+public:
+    static constexpr int kIdleMs = 500;  // sem leituras por isso: pausa
+
+    ScrollTimeline() {
+        m_wall.start();
+        m_frame.setTimerType(Qt::PreciseTimer);
+    }
+
+    QTimer* frameTimer() { return &m_frame; }   // ligar no stepFrame() do widget
+
+    qint64 nowMs() const { return (m_paused ? m_pauseStart : m_wall.elapsed()) - m_pausedTotal; }
+    bool   isPaused() const { return m_paused; }
+
+    // leitura nova: a linha volta a andar se a faixa está na tela
+    void reading(bool visible, const QScreen* screen) {
+        m_lastRead = m_wall.elapsed();
+        if (visible) resume(screen);
+    }
+    // tracker parado (ou página escondida)
+    bool idle() const { return m_wall.elapsed() - m_lastRead > kIdleMs; }
+
+    void resume(const QScreen* screen) {
+        if (!m_paused) return;
+        m_pausedTotal += m_wall.elapsed() - m_pauseStart;
+        m_paused = false;
+        const qreal hz = screen ? screen->refreshRate() : 60.0;
+        m_frame.start(qMax(4, qRound(1000.0 / qBound(30.0, hz, 240.0))));
+    }
+    void pause() {
+        if (m_paused) return;
+        m_pauseStart = m_wall.elapsed();
+        m_paused = true;
+        m_frame.stop();
+    }
+
+    void   setPxPerMs(double v) { m_pxPerMs = v; }   // lógico
+    double pxPerMs() const { return m_pxPerMs; }
+
+    // imagem nova: a coluna da direita passa a ser o "agora"
+    void reanchor(qreal dpr) {
+        m_dpr = dpr;
+        m_anchorMs = nowMs();
+        m_scrolled = 0;
+    }
+
+    // rola `img` até o agora; paintColumns(x0, x1) repinta as colunas (px
+    // do device) que entraram pela direita. Devolve as colunas roladas.
+    template <typename PaintColumns>
+    int scroll(QImage& img, PaintColumns paintColumns) {
+        const qint64 target = qint64(std::floor((nowMs() - m_anchorMs) * m_pxPerMs * m_dpr));
+        const int dx = int(qMin<qint64>(target - m_scrolled, img.width()));
+        if (dx <= 0) return 0;
+        if (dx >= img.width()) paintColumns(0, img.width());
+        else { scrollImageLeft(img, dx); paintColumns(img.width() - dx, img.width()); }
+        m_scrolled = target;
+        return dx;
+    }
+
+    // x lógico de um instante da linha, com o "agora" em nowX
+    qreal xForMs(qint64 ms, qreal nowX) const {
+        const double px = (ms - m_anchorMs) * m_pxPerMs * m_dpr;   // device
+        return nowX - (m_scrolled - px) / m_dpr;
+    }
+
+private:
+    QElapsedTimer m_wall;
+    qint64 m_pausedTotal = 0;
+    qint64 m_pauseStart  = 0;
+    bool   m_paused      = true;
+    qint64 m_lastRead    = 0;
+    QTimer m_frame;
+    double m_pxPerMs  = 0.06;
+    qreal  m_dpr      = 1.0;
+    qint64 m_scrolled = 0;
+    qint64 m_anchorMs = 0;
+};
+
+// Cores comuns das faixas (fundo, linhas de pauta/grade, texto); mesmas
+// da pauta do gerador por padrão.
+struct StripColors {
+    QColor bg    = QColor("#121212");
+    QColor lines = QColor("#3C3C40");
+    QColor text  = QColor("#E0E0E0");
+};
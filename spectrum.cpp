@@ -0,0 +1,101 @@
+#include "spectrum.h"
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+
+void Spectrum::prepare(int frameSize, int sampleRate, double minHz, double maxHz, int bands)
+{
+    m_frame = frameSize;
+    m_sr    = sampleRate;
+    m_n     = 1;
+    while (m_n < frameSize) m_n <<= 1;   // zero-padding até a potência de 2
+
+    m_re.fill(0.0f, m_n);
+    m_im.fill(0.0f, m_n);
+    m_mag.fill(0.0f, m_n / 2 + 1);
+
+    m_cos.resize(m_n / 2);
+    m_sin.resize(m_n / 2);
+    for (int k = 0; k < m_n / 2; ++k) {
+        const double a = -2.0 * M_PI * k / m_n;
+        m_cos[k] = float(std::cos(a));
+        m_sin[k] = float(std::sin(a));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < m_n) ++bits;
+    m_rev.resize(m_n);
+    for (int i = 0; i < m_n; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+        m_rev[i] = r;
+    }
+
+    // bandas com a mesma razão de frequência; banda mais larga que um bin
+    // pega o pico dos bins, mais estreita interpola no centro geométrico
+    m_minHz = std::max(1.0, minHz);
+    m_maxHz = std::min(maxHz, sampleRate / 2.0);
+    const double ratio = std::pow(m_maxHz / m_minHz, 1.0 / bands);
+    const double binHz = double(sampleRate) / m_n;
+    m_bands.resize(bands);
+    m_db.fill(-120.0f, bands);
+    for (int i = 0; i < bands; ++i) {
+        const double fLo = m_minHz * std::pow(ratio, i);
+        const double fHi = fLo * ratio;
+        Band& b = m_bands[i];
+        b.lo = int(std::ceil(fLo / binHz));
+        b.hi = std::min(m_n / 2, int(std::floor(fHi / binHz)));
+        if (b.hi < b.lo) {
+            const double c = std::sqrt(fLo * fHi) / binHz;
+            b.lo   = std::min(m_n / 2 - 1, int(c));
+            b.hi   = b.lo - 1;
+            b.frac = float(qBound(0.0, c - b.lo, 1.0));   // lo preso no topo: sem extrapolar
+        }
+    }
+}
+
+void Spectrum::fft()
+{
+    float* re = m_re.data();
+    float* im = m_im.data();
+    for (int i = 0; i < m_n; ++i) {
+        const int j = m_rev[i];
+        if (j > i) { std::swap(re[i], re[j]); std::swap(im[i], im[j]); }
+    }
+    for (int len = 2; len <= m_n; len <<= 1) {
+        const int half = len >> 1;
+        const int step = m_n / len;
+        for (int s = 0; s < m_n; s += len) {
+            for (int k = 0; k < half; ++k) {
+                const float wr = m_cos[k * step], wi = m_sin[k * step];
+                const int a = s + k, b = a + half;
+                const float tr = re[b] * wr - im[b] * wi;
+                const float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr; im[b] = im[a] - ti;
+                re[a] += tr;        im[a] += ti;
+            }
+        }
+    }
+}
+
+void Spectrum::process(const float* frame, float windowSum)
+{
+    if (m_n == 0) return;
+    std::copy(frame, frame + m_frame, m_re.begin());
+    std::fill(m_re.begin() + m_frame, m_re.end(), 0.0f);
+    std::fill(m_im.begin(), m_im.end(), 0.0f);
+    fft();
+
+    const float norm = 2.0f / std::max(1.0f, windowSum);   // amplitude de pico
+    for (int k = 0; k <= m_n / 2; ++k)
+        m_mag[k] = std::sqrt(m_re[k] * m_re[k] + m_im[k] * m_im[k]) * norm;
+
+    float* db = m_db.data();
+    for (int i = 0; i < m_bands.size(); ++i) {
+        const Band& b = m_bands[i];
+        float m;
+        if (b.hi >= b.lo) m = *std::max_element(m_mag.constBegin() + b.lo, m_mag.constBegin() + b.hi + 1);
+        else              m = m_mag[b.lo] * (1.0f - b.frac) + m_mag[b.lo + 1] * b.frac;
+        db[i] = 20.0f * std::log10(m + 1e-7f);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <QVector>
+
+// Espectro em bandas logarítmicas de um quadro já janelado (o mesmo da
+// análise de pitch). Tudo que depende do tamanho — twiddles, bit-reversal e
+// a tabela bins -> bandas — é montado em prepare(); process() não aloca.
+class Spectrum
+{
+public:
+    void prepare(int frameSize, int sampleRate, double minHz, double maxHz, int bands);
+    bool isPreparedFor(int frameSize, int sampleRate, int bands) const {
+        return frameSize == m_frame && sampleRate == m_sr && bands == m_db.size();
+    }
+
+    // frame: frameSize samples com janela; windowSum = soma da janela
+    // (normaliza para dBFS de uma senoide)
+    void process(const float* frame, float windowSum);
+
+    const QVector<float>& bandsDb() const { return m_db; }
+    double minHz() const { return m_minHz; }
+    double maxHz() const { return m_maxHz; }
+
+private:
+    void fft();                          // in-place em m_re/m_im
+
+    struct Band {
+        int   lo = 0, hi = -1;           // bins [lo, hi]; hi < lo = interpola lo..lo+1
+        float frac = 0.0f;
+    };
+
+    int    m_n     = 0;                  // tamanho da FFT (potência de 2 >= quadro)
+    int    m_frame = 0;
+    int    m_sr    = 0;
+    double m_minHz = 0.0, m_maxHz = 0.0;
+    QVector<float> m_re, m_im;
+    QVector<float> m_cos, m_sin;         // twiddles (n/2)
+    QVector<int>   m_rev;                // bit-reversal
+    QVector<float> m_mag;                // |X| dos bins 0..n/2
+    QVector<Band>  m_bands;
+    QVector<float> m_db;
+};
@@ -0,0 +1,167 @@
+#include "spectrumwidget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFontMetricsF>
+#include <QtMath>
+#include <cmath>
+
+SpectrumWidget::SpectrumWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent, true);
+    setAutoFillBackground(false);
+    setMinimumHeight(120);
+
+    // paleta da cascata: fundo -> azul -> violeta -> laranja -> amarelo -> branco
+    struct Stop { float at; QColor c; };
+    static const Stop stops[] = {
+        {0.00f, QColor("#121212")}, {0.30f, QColor("#1A2A80")}, {0.55f, QColor("#8A2BE2")},
+        {0.75f, QColor("#FF8C00")}, {0.90f, QColor("#FFE45C")}, {1.00f, QColor("#FFFFFF")}
+    };
+    for (int i = 0; i < 256; ++i) {
+        const float t = i / 255.0f;
+        int s = 0;
+        while (s < 4 && t > stops[s + 1].at) ++s;
+        const float u = (t - stops[s].at) / (stops[s + 1].at - stops[s].at);
+        const QColor& a = stops[s].c;
+        const QColor& b = stops[s + 1].c;
+        m_lut[i] = qRgb(int(a.red()   + (b.red()   - a.red())   * u),
+                        int(a.green() + (b.green() - a.green()) * u),
+                        int(a.blue()  + (b.blue()  - a.blue())  * u));
+    }
+}
+
+void SpectrumWidget::setRangeDb(float floorDb, float topDb)
+{
+    m_floorDb = floorDb;
+    m_topDb   = qMax(floorDb + 10.0f, topDb);
+    update();
+}
+
+int SpectrumWidget::level(float db) const
+{
+    const float t = (db - m_floorDb) / (m_topDb - m_floorDb);
+    return qBound(0, int(t * 255.0f), 255);
+}
+
+void SpectrumWidget::addFrame(const QVector<float>& bandsDb, double minHz, double maxHz)
+{
+    if (!isVisible()) return;
+    const int n = int(bandsDb.size());
+    if (n < 2) return;
+
+    // tamanho novo (só na 1ª vez ou se o tracker mudar as bandas)
+    if (m_waterfall.width() != n || !qFuzzyCompare(minHz, m_minHz) || !qFuzzyCompare(maxHz, m_maxHz)) {
+        m_minHz = minHz;
+        m_maxHz = maxHz;
+        m_waterfall = QImage(n, kRows, QImage::Format_RGB32);
+        m_waterfall.fill(m_lut[0]);
+        m_row = 0;
+        m_filled = 0;
+        m_last.resize(n);
+        m_curve.resize(n);
+        rebuildBackground();
+    }
+    std::copy(bandsDb.constBegin(), bandsDb.constEnd(), m_last.begin());
+
+    // cascata: uma scanline por quadro, a mais nova no topo
+    m_row = (m_row + kRows - 1) % kRows;
+    m_filled = qMin(kRows, m_filled + 1);
+    QRgb* line = reinterpret_cast<QRgb*>(m_waterfall.scanLine(m_row));
+    for (int i = 0; i < n; ++i) line[i] = m_lut[level(m_last[i])];
+
+    updateCurve();
+    update();
+}
+
+void SpectrumWidget::updateCurve()
+{
+    // curva do espectro (pontos reaproveitados)
+    const int n = int(m_last.size());
+    m_curve.resize(n);
+    if (n < 2) return;
+    const qreal dx = m_specRect.width() / (n - 1);
+    for (int i = 0; i < n; ++i) {
+        const qreal t = level(m_last[i]) / 255.0;
+        m_curve[i] = QPointF(m_specRect.left() + i * dx, m_specRect.bottom() - t * m_specRect.height());
+    }
+}
+
+void SpectrumWidget::rebuildBackground()
+{
+    const qreal dpr = devicePixelRatioF();
+    const qreal specH = height() * 0.38;
+    m_specRect = QRectF(0, 0, width(), specH).adjusted(2, 4, -2, -2);
+    m_fallRect = QRectF(0, specH, width(), height() - specH);
+
+    m_background = QPixmap((QSizeF(width(), specH) * dpr).toSize().expandedTo(QSize(1, 1)));
+    m_background.setDevicePixelRatio(dpr);
+    m_background.fill(m_bg);
+
+    QPainter g(&m_background);
+    QFont f = font();
+    f.setPointSizeF(qMax(7.0, specH * 0.09));
+    g.setFont(f);
+    const QFontMetricsF fm(f);
+
+    // grade nas frequências "redondas" (eixo log)
+    const double span = std::log(m_maxHz / m_minHz);
+    for (double hz : {50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0}) {
+        if (hz < m_minHz || hz > m_maxHz) continue;
+        const qreal x = m_specRect.left() + std::log(hz / m_minHz) / span * m_specRect.width();
+        g.setPen(QPen(m_grid, 1.0));
+        g.drawLine(QPointF(x, m_specRect.top()), QPointF(x, m_specRect.bottom()));
+        g.setPen(m_text);
+        const QString label = hz >= 1000.0 ? QStringLiteral("%1k").arg(hz / 1000.0) : QString::number(hz);
+        g.drawText(QPointF(x + 2, m_specRect.top() + fm.ascent()), label);
+    }
+    // mesmo quadro no layout novo: a curva não some até o próximo chegar
+    updateCurve();
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent*)
+{
+    if (!qFuzzyCompare(m_background.devicePixelRatio(), devicePixelRatioF()))
+        rebuildBackground();
+    QPainter p(this);
+    p.drawPixmap(0, 0, m_background);
+
+    if (m_waterfall.isNull()) {
+        p.fillRect(m_fallRect, m_bg);
+        return;
+    }
+
+    // anel -> tela em 2 cópias: [m_row, fim) no topo, [0, m_row) embaixo
+    const qreal rowH = m_fallRect.height() / kRows;
+    const int w = m_waterfall.width();
+    const int top = kRows - m_row;
+    p.drawImage(QRectF(m_fallRect.left(), m_fallRect.top(), m_fallRect.width(), top * rowH),
+                m_waterfall, QRectF(0, m_row, w, top));
+    if (m_row > 0)
+        p.drawImage(QRectF(m_fallRect.left(), m_fallRect.top() + top * rowH, m_fallRect.width(), m_row * rowH),
+                    m_waterfall, QRectF(0, 0, w, m_row));
+
+    if (m_filled > 0 && m_curve.size() > 1) {
+        p.setRenderHint(QPainter::Antialiasing, true);
+        p.setPen(QPen(m_line, 1.4));
+        p.drawPolyline(m_curve);
+    }
+}
+
+void SpectrumWidget::resizeEvent(QResizeEvent* e)
+{
+    rebuildBackground();
+    QWidget::resizeEvent(e);
+}
+
+void SpectrumWidget::showEvent(QShowEvent* e)
+{
+    QWidget::showEvent(e);
+    emit activeChanged(true);
+}
+
+void SpectrumWidget::hideEvent(QHideEvent* e)
+{
+    emit activeChanged(false);
+    QWidget::hideEvent(e);
+}
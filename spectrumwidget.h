@@ -0,0 +1,61 @@
+#pragma once
+#include <QWidget>
+#include <QColor>
+#include <QImage>
+#include <QPixmap>
+#include <QPolygonF>
+#include <QVector>
+
+// Espectro ao vivo + espectrograma (cascata) do áudio do afinador, para
+// diagnosticar leituras ruins (zumbido, harmônicos fortes, sala ruidosa).
+// Recebe as bandas log do PitchTracker (spectrumUpdated); a cascata é uma
+// QImage usada como anel de scanlines — cada quadro escreve UMA linha via a
+// tabela de cores, sem alocar. activeChanged() avisa quando a vista entra
+// ou sai da tela para o tracker ligar/desligar a FFT.
+class SpectrumWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SpectrumWidget(QWidget* parent = nullptr);
+
+    void setRangeDb(float floorDb, float topDb);   // default -100..-10 dBFS
+
+signals:
+    void activeChanged(bool visible);
+
+public slots:
+    // ligar em PitchTracker::spectrumUpdated
+    void addFrame(const QVector<float>& bandsDb, double minHz, double maxHz);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void showEvent(QShowEvent*) override;
+    void hideEvent(QHideEvent*) override;
+    QSize sizeHint() const override { return {560, 200}; }
+
+private:
+    static constexpr int kRows = 256;    // linhas de história da cascata
+
+    void rebuildBackground();            // grade e rótulos de frequência
+    int  level(float db) const;          // dB -> índice da tabela (0..255)
+    void updateCurve();                  // m_last -> m_curve no m_specRect atual
+
+    QVector<float> m_last;               // último quadro (cópia própria)
+    QPolygonF m_curve;
+    QImage   m_waterfall;                // bandas x kRows, anel de scanlines
+    int      m_row = 0;                  // linha mais nova
+    int      m_filled = 0;
+    QRgb     m_lut[256];
+    float    m_floorDb = -100.0f;
+    float    m_topDb   = -10.0f;
+    double   m_minHz = 40.0, m_maxHz = 8000.0;
+
+    QRectF   m_specRect, m_fallRect;
+    QPixmap  m_background;               // fundo do espectro (fixo)
+
+    QColor   m_bg    = QColor("#121212");
+    QColor   m_grid  = QColor("#2A2A2E");
+    QColor   m_line  = QColor(0x4f, 0x8a, 0xff);
+    QColor   m_text  = QColor("#AAAAAA");
+};
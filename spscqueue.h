@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Fila sem lock de um produtor e um consumidor (ex.: GUI -> callback de
+// áudio). Capacidade fixa N-1 (N potência de 2); push/pop nunca alocam
+// nem bloqueiam: push() devolve false com a fila cheia.
+template <typename T, std::size_t N>
+class SpscQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N deve ser potência de 2");
+
+public:
+    bool push(const T& v) {
+        const std::size_t h = m_head.load(std::memory_order_relaxed);
+        const std::size_t next = (h + 1) & (N - 1);
+        if (next == m_tail.load(std::memory_order_acquire)) return false;
+        m_buf[h] = v;
+        m_head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const std::size_t t = m_tail.load(std::memory_order_relaxed);
+        if (t == m_head.load(std::memory_order_acquire)) return false;
+        out = m_buf[t];
+        m_tail.store((t + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    T m_buf[N];
+    alignas(64) std::atomic<std::size_t> m_head {0};   // produtor
+    alignas(64) std::atomic<std::size_t> m_tail {0};   // consumidor
+};
@@ -106,14 +106,6 @@ QString StaffNoteWidget::nameFromMidiFlats(int midi)
     return QString::fromLatin1(names[pc]) + QString::number(oct);
 }
 
-bool StaffNoteWidget::fontHasAccidentals(const QFont &f)
-{
-    QFontMetricsF fm(f);
-    // tenta medir ♯ (U+266F) e ♭ (U+266D); se largura é ~0, provavelmente não há
-    return fm.horizontalAdvance(QString::fromUtf8("♯")) > 0.1
-           && fm.horizontalAdvance(QString::fromUtf8("♭")) > 0.1;
-}
-
 // ======= API =======
 StaffNoteWidget::StaffNoteWidget(QWidget *parent)
     : QWidget(parent)
@@ -182,6 +174,7 @@ void StaffNoteWidget::computeLayout(QRectF &staffRect, qreal &lineGap, QRectF &l
 void StaffNoteWidget::setClefImage(const QPixmap& pm)
 {
     m_clef = pm;
+    m_clefScaled = QPixmap();
     update();
 }
 
@@ -190,12 +183,20 @@ void StaffNoteWidget::setClefImageFile(const QString& path)
     QPixmap pm(path);
     if (!pm.isNull()) {
         m_clef = pm;
+        m_clefScaled = QPixmap();
         update();
     }
 }
 
+void StaffNoteWidget::changeEvent(QEvent* e)
+{
+    if (e->type() == QEvent::FontChange) m_textCache.invalidate();
+    QWidget::changeEvent(e);
+}
+
 void StaffNoteWidget::paintEvent(QPaintEvent*)
 {
+    m_textCache.checkDpr(devicePixelRatioF());
     QPainter p(this);
     p.setRenderHint(QPainter::Antialiasing, true);
     p.fillRect(rect(), m_bg);
@@ -211,11 +212,12 @@ void StaffNoteWidget::paintEvent(QPaintEvent*)
     // rótulo da nota (canto superior direito)
     if (m_showLabel) {
         p.setPen(m_text);
-        QFont f = font(); f.setBold(true);
-        f.setPointSizeF(qMax(10.0, height()*0.12));
-        p.setFont(f);
-        QString label = (m_pref == AccPref::Flats) ? nameFromMidiFlats(m_midi) : nameFromMidiSharps(m_midi);
-        p.drawText(rect().adjusted(0, 2, -8, 0), Qt::AlignTop | Qt::AlignRight, label);
+        p.setFont(m_textCache.font(kLabelFont, font(), qMax(10.0, height()*0.12), true));
+        const bool flats = (m_pref == AccPref::Flats);
+        const int  midi  = clampMidi(m_midi);
+        TextCache::draw(p, rect().adjusted(0, 2, -8, 0), Qt::AlignTop | Qt::AlignRight,
+                        m_textCache.text(kLabelFont, midi + (flats ? 128 : 0), [=]{
+                            return flats ? nameFromMidiFlats(midi) : nameFromMidiSharps(midi); }));
     }
 }
 
@@ -240,47 +242,66 @@ void StaffNoteWidget::drawTrebleClef(QPainter &p, QRectF area, qreal lineGap)
         const qreal sy = target.height() / imgSz.height();
         const qreal s  = qMin(sx, sy);
 
-        const QSizeF drawSz(imgSz.width()*s, imgSz.height()*s);
-        const QPointF pos(target.left() + (target.width()  - drawSz.width())  / 2.0,
-                          target.top()  + (target.height() - drawSz.height()) / 2.0);
+        // reamostra 1x no tamanho exato em pixels do device; no paint é só
+        // cópia (refeito quando o layout ou o DPR mudam)
+        const qreal dpr = devicePixelRatioF();
+        const QSize px = (QSizeF(imgSz.width()*s, imgSz.height()*s) * dpr).toSize();
+        if (m_clefScaled.isNull() || m_clefScaled.size() != px
+            || !qFuzzyCompare(m_clefScaled.devicePixelRatio(), dpr)) {
+            m_clefScaled = m_clef.scaled(px, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            m_clefScaled.setDevicePixelRatio(dpr);
+        }
+
+        const QSizeF drawSz = QSizeF(px) / dpr;
+        // posição alinhada ao pixel do device: a cópia não reamostra
+        const QPointF pos(qRound((target.left() + (target.width()  - drawSz.width())  / 2.0) * dpr) / dpr,
+                          qRound((target.top()  + (target.height() - drawSz.height()) / 2.0) * dpr) / dpr);
 
-        p.drawPixmap(QRectF(pos, drawSz), m_clef, QRectF(QPointF(0,0), imgSz));
+        p.drawPixmap(pos, m_clefScaled);
         return; // já desenhou a clave via imagem
     }
 
-    // Clave de Sol estilizada (path leve, sem fonte)
+    // Clave de Sol estilizada (path leve, sem fonte), montada na origem e
+    // guardada por lineGap/largura; no paint só translada
     // Foco: dar uma espiral que cruza a 2ª linha (G4)
-    const qreal x = area.center().x();
-    const qreal yMid = area.top() + 1*lineGap + lineGap; // linha 2 (G4)
-    QPainterPath path;
-
-    const qreal h = area.height();
     const qreal w = area.width()*0.45;
-    const qreal r = lineGap*0.85;
-
-    // haste
-    path.moveTo(x + w*0.05, yMid - 2.5*lineGap);
-    path.cubicTo(x + w*0.20, yMid - 3.2*lineGap,
-                 x - w*0.35, yMid - 2.7*lineGap,
-                 x - w*0.10, yMid - 1.6*lineGap);
-    path.cubicTo(x + w*0.25, yMid - 0.6*lineGap,
-                 x + w*0.15, yMid + 0.4*lineGap,
-                 x - w*0.05, yMid + 0.9*lineGap);
-
-    // espiral
-    path.addEllipse(QPointF(x - r*0.1, yMid + 0.2*lineGap), r, r);
-
-    // gancho inferior
-    QPainterPath hook;
-    hook.moveTo(x - r*0.9, yMid + 1.2*lineGap);
-    hook.cubicTo(x - r*1.2, yMid + 2.0*lineGap,
-                 x + r*0.8, yMid + 2.0*lineGap,
-                 x + r*0.5, yMid + 0.9*lineGap);
+    if (m_clefPath.isEmpty() || !qFuzzyCompare(m_clefPathGap, lineGap)
+        || !qFuzzyCompare(m_clefPathW, w)) {
+        const qreal r = lineGap*0.85;
+        QPainterPath path;
+
+        // haste
+        path.moveTo(w*0.05, -2.5*lineGap);
+        path.cubicTo(w*0.20, -3.2*lineGap,
+                     -w*0.35, -2.7*lineGap,
+                     -w*0.10, -1.6*lineGap);
+        path.cubicTo(w*0.25, -0.6*lineGap,
+                     w*0.15,  0.4*lineGap,
+                     -w*0.05,  0.9*lineGap);
+
+        // espiral
+        path.addEllipse(QPointF(-r*0.1, 0.2*lineGap), r, r);
+
+        // gancho inferior (subpath separado, como antes)
+        path.moveTo(-r*0.9, 1.2*lineGap);
+        path.cubicTo(-r*1.2, 2.0*lineGap,
+                     r*0.8, 2.0*lineGap,
+                     r*0.5, 0.9*lineGap);
+
+        m_clefPath    = path;
+        m_clefPathGap = lineGap;
+        m_clefPathW   = w;
+    }
 
+    const qreal x = area.center().x();
+    const qreal yMid = area.top() + 1*lineGap + lineGap; // linha 2 (G4)
+    p.save();
+    p.translate(x, yMid);
     p.setRenderHint(QPainter::Antialiasing, true);
     p.setPen(QPen(QColor("#C0C0C0"), 1.6, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-    p.drawPath(path);
-    p.drawPath(hook);
+    p.setBrush(Qt::NoBrush);
+    p.drawPath(m_clefPath);
+    p.restore();
 }
 
 void StaffNoteWidget::drawNoteAndLedger(QPainter &p, QRectF staffRect, qreal lineGap)
@@ -340,30 +361,24 @@ void StaffNoteWidget::drawNoteAndLedger(QPainter &p, QRectF staffRect, qreal lin
         }
     }
 
-    // acidente (♯/♭) à esquerda da cabeça (se necessário)
-    // decide se precisa ♯/♭ observando o nome textual pela preferência
-    QString name = (m_pref == AccPref::Flats) ? nameFromMidiFlats(midi)
-                                              : nameFromMidiSharps(midi);
-    bool sharp = name.contains("♯") || name.contains('#');
-    bool flat  = name.contains("♭") || name.contains('b');
-
-    if (sharp || flat) {
-        QFont f = font();
-        f.setBold(true);
-        f.setPointSizeF(qMax(10.0, lineGap*1.2));
-        p.setFont(f);
+    // acidente (♯/♭) à esquerda da cabeça (se necessário): teclas pretas,
+    // grafadas pela preferência
+    static const bool black[12] = {false,true,false,true,false,false,
+                                   true,false,true,false,true,false};
+    if (black[pc]) {
+        const bool sharp = (m_pref != AccPref::Flats);
+        p.setFont(m_textCache.font(kAccidentalFont, font(), qMax(10.0, lineGap*1.2), true));
         p.setPen(m_text);
 
-        const QString sym = sharp ? QString::fromUtf8("♯") : QString::fromUtf8("♭");
-        QFontMetricsF fm(f);
-        QString drawSym = sym;
-
-        // fallback caso a fonte não tenha os símbolos
-        if (!fontHasAccidentals(f)) {
-            drawSym = sharp ? "#" : "b";
-        }
+        // fallback caso a fonte não tenha os símbolos (medido 1x por fonte)
+        const bool glyphs = m_textCache.hasGlyphs(kAccidentalFont, QString::fromUtf8("♯♭"));
+        const int  which  = (sharp ? 0 : 1) + (glyphs ? 0 : 2);
+        const QStaticText& sym = m_textCache.text(kAccidentalFont, which, [which]{
+            static const char* syms[4] = {"♯", "♭", "#", "b"};
+            return QString::fromUtf8(syms[which]); });
 
-        const qreal xAcc = headRect.left() - fm.horizontalAdvance(drawSym) - lineGap*0.4;
-        p.drawText(QPointF(xAcc, yNote + fm.ascent()/2.8), drawSym);
+        const qreal ascent = m_textCache.ascent(kAccidentalFont);
+        const qreal xAcc = headRect.left() - sym.size().width() - lineGap*0.4;
+        p.drawStaticText(QPointF(xAcc, yNote + ascent/2.8 - ascent), sym);
     }
 }
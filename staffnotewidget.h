@@ -2,6 +2,8 @@
 #include <QWidget>
 #include <QColor>
 #include <QPixmap>
+#include <QPainterPath>
+#include "textcache.h"
 
 class StaffNoteWidget : public QWidget
 {
@@ -39,6 +41,7 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *e) override;
+    void changeEvent(QEvent *e) override;
     QSize sizeHint() const override { return { 560, 200 }; }
 
 private:
@@ -54,7 +57,6 @@ private:
     static int   letterIndexForPcFlats (int pc); // idem, preferindo bemois
     static int   letterIndexFromNameQChar(QChar c); // 'C'..'B' → 0..6
     static int   diatonicStepFrom(int letterIndex, int octave);
-    static bool  fontHasAccidentals(const QFont &f);
 
     // desenho
     void drawStaff(QPainter &p, QRectF area, qreal lineGap);
@@ -63,6 +65,15 @@ private:
     void computeLayout(QRectF &staffRect, qreal &lineGap, QRectF &leftGutter) const;
 
     QPixmap m_clef;  // se vazio, desenha a clave vetorial de fallback
+    QPixmap m_clefScaled;            // m_clef já no tamanho do layout (px do device)
+    QPainterPath m_clefPath;         // clave de fallback na origem
+    qreal   m_clefPathGap = 0.0;     // lineGap/largura com que m_clefPath foi montada
+    qreal   m_clefPathW   = 0.0;
+
+    // rótulo (128 notas x grafia) e acidente com o teste de glifos feito
+    // uma vez por fonte; refeitos só em resize/DPR/troca de fonte
+    enum TextSlot { kLabelFont, kAccidentalFont };
+    TextCache m_textCache;
 
 public slots:
     void setFrequencyHz(double hz) { setFrequency(hz, AccPref::Sharps); }
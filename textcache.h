@@ -0,0 +1,93 @@
+#pragma once
+#include <QFont>
+#include <QFontMetricsF>
+#include <QHash>
+#include <QPainter>
+#include <QStaticText>
+
+// Cache de texto de um widget: fontes já ajustadas, QStaticText com o
+// layout feito uma vez e o resultado de "a fonte tem estes glifos?".
+// Cada uso de fonte é um `slot`; se o tamanho pedido muda (resize, outro
+// layout) só aquele slot é refeito. O dono chama invalidate() na troca de
+// fonte e checkDpr() no início do paint; fora disso nada de QFont, QString
+// ou layout de texto por frame.
+class TextCache
+{
+public:
+    void invalidate() { m_slots.clear(); }
+
+    // DPR mudou (tela trocou): tudo é refeito na nova resolução
+    void checkDpr(qreal dpr) {
+        if (qFuzzyCompare(dpr, m_dpr)) return;
+        m_dpr = dpr;
+        invalidate();
+    }
+
+    // fonte base do widget com tamanho/peso
+    const QFont& font(int slot, const QFont& base, qreal pointSize, bool bold = false) {
+        Slot& s = m_slots[slot];
+        if (!s.valid || !qFuzzyCompare(s.pointSize, pointSize) || s.bold != bold) {
+            s = Slot();
+            s.font = base;
+            s.font.setBold(bold);
+            s.font.setPointSizeF(pointSize);
+            s.pointSize = pointSize;
+            s.bold      = bold;
+            s.ascent    = QFontMetricsF(s.font).ascent();
+            s.valid     = true;
+        }
+        return s.font;
+    }
+    qreal ascent(int slot) const { return m_slots.value(slot).ascent; }
+
+    // texto na fonte do slot (chame font() antes); make() só roda na 1ª vez
+    template <typename Make>
+    const QStaticText& text(int slot, int index, Make make) {
+        Slot& s = m_slots[slot];
+        auto it = s.texts.find(index);
+        if (it == s.texts.end()) {
+            QStaticText st(make());
+            st.setTextFormat(Qt::PlainText);
+            st.prepare(QTransform(), s.font);
+            it = s.texts.insert(index, st);
+        }
+        return *it;
+    }
+
+    // todos os caracteres de `chars` têm glifo na fonte do slot?
+    bool hasGlyphs(int slot, const QString& chars) {
+        Slot& s = m_slots[slot];
+        if (s.glyphs < 0) {
+            const QFontMetricsF fm(s.font);
+            s.glyphs = 1;
+            // largura ~0 = nem a fonte nem o fallback do sistema têm o glifo
+            for (const QChar c : chars)
+                if (fm.horizontalAdvance(QString(c)) <= 0.1) { s.glyphs = 0; break; }
+        }
+        return s.glyphs == 1;
+    }
+
+    // como drawText(box, align, ...), com a fonte do slot já no painter
+    static void draw(QPainter& p, const QRectF& box, int align, const QStaticText& st) {
+        const QSizeF sz = st.size();
+        qreal x = box.left(), y = box.top();
+        if (align & Qt::AlignHCenter)     x = box.center().x() - sz.width() / 2.0;
+        else if (align & Qt::AlignRight)  x = box.right() - sz.width();
+        if (align & Qt::AlignVCenter)     y = box.center().y() - sz.height() / 2.0;
+        else if (align & Qt::AlignBottom) y = box.bottom() - sz.height();
+        p.drawStaticText(QPointF(x, y), st);
+    }
+
+private:
+    struct Slot {
+        QFont font;
+        qreal pointSize = 0.0;
+        qreal ascent    = 0.0;
+        bool  bold      = false;
+        bool  valid     = false;
+        int   glyphs    = -1;             // -1 = ainda não medido
+        QHash<int, QStaticText> texts;
+    };
+    QHash<int, Slot> m_slots;
+    qreal m_dpr = 0.0;
+};
@@ -1,115 +1,295 @@
 #include "tonegenerator.h"
+#include "audiosynth.h"
+#include "audioengine.h"
 
-#include <QAudioSink>
-#include <QMediaDevices>
-#include <QAudioDevice>
 #include <QtMath>
 #include <QDebug>
-#include <QIODevice>
 
 // ===================== SineStream (gerador) =========================
-class ToneGenerator::SineStream : public QIODevice
+// Fonte do AudioEngine: soma a voz senoidal ao mix do callback.
+class ToneGenerator::SineStream : public AudioSource
 {
 public:
     explicit SineStream(ToneGenerator* host)
-        : QIODevice(host), m_host(host)
+        : m_host(host)
     {
-        open(QIODevice::ReadOnly);
     }
 
-    void setSampleRate(int sr) {
-        m_sr = qMax(8000, sr);
-        m_rampSamples = qMax(1, m_sr / 200); // ~5ms
+    void prepare(int sampleRate) override {
+        m_voice.setSampleRate(sampleRate);
     }
 
-    void setVolume(float vol01) {
-        m_targetAmp = qBound(0.0f, vol01, 1.0f);
+    // GUI: gate e volume só são publicados aqui; quem mexe na voz é o
+    // callback, uma vez por bloco (applyControls)
+    void gate(bool on) {
+        m_gateOn.store(on, std::memory_order_relaxed);
+        m_gateSerial.fetch_add(1, std::memory_order_release);
     }
 
-    void gate(bool on) {
-        m_targetAmp = on ? m_volume : 0.0f; // rumo ao volume atual
+    // Marca o próximo sample audível (amp > 0), no relógio do AudioEngine,
+    // para medir a latência do start()
+    void armLatencyProbe() {
+        m_probeFrame.store(-1, std::memory_order_relaxed);
+        m_probeArmed.store(true, std::memory_order_release);
+    }
+    qint64 probeFrame() const { return m_probeFrame.load(std::memory_order_acquire); }
+
+    // ---- sequenciador: lista pré-alocada (2 slots), trocada sem lock ----
+    struct SeqEvent {
+        qint64 at;      // sample relativo ao início do programa
+        double hz;      // <= 0 => fecha o gate (pausa/articulação)
+        int    step;    // passo que passa a soar
+    };
+    static constexpr int kMaxSeqEvents = 2048;
+
+    // GUI: retira um programa ainda não consumido e devolve o slot livre
+    QVector<SeqEvent>& beginSequenceWrite() {
+        int st = m_seqState.load(std::memory_order_acquire);
+        while ((st & kSeqPending)
+               && !m_seqState.compare_exchange_weak(st, st & ~kSeqPending,
+                                                    std::memory_order_acq_rel)) {}
+        // sem pendência só a GUI altera o estado; o slot livre é o inativo
+        SeqProgram& prog = m_seqSlots[1 - (st & 1)];
+        prog.events.clear();
+        return prog.events;
     }
 
+    // GUI: publica o slot preenchido; o callback troca no próximo bloco
+    void commitSequence(qint64 period) {
+        int st = m_seqState.load(std::memory_order_acquire);
+        m_seqSlots[1 - (st & 1)].period = period;
+        m_seqDone.store(false, std::memory_order_relaxed);
+        m_seqState.store((st & 1) | kSeqPending, std::memory_order_release);
+    }
+
+    void setSeqLoop(bool on)  { m_seqLoop.store(on, std::memory_order_relaxed); }
+    int  currentStep() const  { return m_curStep.load(std::memory_order_relaxed); }
+    bool sequenceDone() const { return m_seqDone.load(std::memory_order_relaxed); }
+
     void setLogicalVolume(float vol01) {
-        m_volume = qBound(0.0f, vol01, 1.0f);
-        // se já estou "on", quero ir até o novo volume; se "off", alvo é 0
-        m_targetAmp = (m_targetAmp > 0.0f) ? m_volume : 0.0f;
+        m_volume.store(qBound(0.0f, vol01, 1.0f), std::memory_order_relaxed);
     }
 
-protected:
-    qint64 readData(char* data, qint64 maxlen) override
+    void render(float* mix, int frames, qint64 clock) override
     {
-        // 16-bit mono
-        const int16_t* end = reinterpret_cast<const int16_t*>(data + maxlen);
-        int16_t* out = reinterpret_cast<int16_t*>(data);
+        bool probe = m_probeArmed.load(std::memory_order_acquire);
 
-        const double twoPi = 2.0 * M_PI;
+        pickupSequence();
+        applyControls();
+        const double hostHz = m_host->m_freqHz.load(std::memory_order_relaxed);
 
-        while (reinterpret_cast<char*>(out) < reinterpret_cast<const char*>(end)) {
-            const double f = m_host->m_freqHz.load(std::memory_order_relaxed);
-            const double inc = twoPi * f / double(m_sr);
+        for (int i = 0; i < frames; ++i) {
+            if (m_seqOn) advanceSequence();
+            const double f = m_seqHzActive ? m_seqHz : hostHz;
 
-            // Rampa de amplitude linear
-            if (m_amp < m_targetAmp) {
-                m_amp = qMin(m_targetAmp, m_amp + (1.0f / m_rampSamples));
-            } else if (m_amp > m_targetAmp) {
-                m_amp = qMax(m_targetAmp, m_amp - (1.0f / m_rampSamples));
+            // Rampa de amplitude + seno (mesmo código do render offline)
+            const double s = m_voice.next(f);
+
+            if (probe && m_voice.amp() > 0.0f) {
+                m_probeFrame.store(clock + i, std::memory_order_release);
+                m_probeArmed.store(false, std::memory_order_relaxed);
+                probe = false;
             }
 
-            // Seno
-            const double s = std::sin(m_phase) * double(m_amp);
-            m_phase += inc;
-            if (m_phase >= twoPi) m_phase -= twoPi;
+            mix[i] += float(s);
 
-            const int sample = int(qBound(-1.0, s, 1.0) * 32767.0);
-            *out++ = qint16(sample);
+            // fim do rabo do último passo: volta à frequência da nota do host
+            if (m_seqHzActive && !m_seqOn && m_voice.amp() <= 0.0f) m_seqHzActive = false;
         }
-        return maxlen;
     }
 
-    qint64 writeData(const char*, qint64) override { return -1; }
-
 private:
+    struct SeqProgram {
+        QVector<SeqEvent> events;
+        qint64 period = 0;      // duração total (samples) — ponto de loop
+        SeqProgram() { events.reserve(kMaxSeqEvents); }
+    };
+    static constexpr int kSeqPending = 2; // bit0 = slot ativo, bit1 = pendente
+
+    void pickupSequence() {
+        int st = m_seqState.load(std::memory_order_acquire);
+        if (!(st & kSeqPending)) return;
+        const int next = 1 - (st & 1);
+        if (!m_seqState.compare_exchange_strong(st, next, std::memory_order_acq_rel))
+            return; // GUI retirou o programa neste instante
+        m_seq    = &m_seqSlots[next];
+        m_seqIdx = 0;
+        m_seqPos = 0;
+        m_seqOn  = !m_seq->events.isEmpty() && m_seq->period > 0;
+        if (!m_seqOn) {
+            // programa vazio (stopSequence): o último passo não pode ficar soando
+            m_voice.setTargetAmp(0.0f);
+            m_curStep.store(-1, std::memory_order_relaxed);
+        }
+    }
+
+    // depois do pickupSequence: um gate publicado depois do programa vazio
+    // (start() logo após stopSequence()) ainda vale neste bloco
+    void applyControls() {
+        m_blockVol = m_volume.load(std::memory_order_relaxed);
+        const unsigned serial = m_gateSerial.load(std::memory_order_acquire);
+        if (serial != m_gateSeen) {
+            m_gateSeen = serial;
+            m_voice.setTargetAmp(m_gateOn.load(std::memory_order_relaxed) ? m_blockVol : 0.0f);
+        } else if (m_voice.targetAmp() > 0.0f) {
+            m_voice.setTargetAmp(m_blockVol);   // ligado: segue o volume atual
+        }
+    }
+
+    // chamado uma vez por sample enquanto há programa ativo
+    void advanceSequence() {
+        const QVector<SeqEvent>& ev = m_seq->events;
+        while (m_seqIdx < ev.size() && ev[m_seqIdx].at <= m_seqPos) {
+            const SeqEvent& e = ev[m_seqIdx++];
+            if (e.hz > 0.0) {
+                m_seqHz = e.hz;
+                m_seqHzActive = true;
+                m_voice.setTargetAmp(m_blockVol);
+            } else {
+                m_voice.setTargetAmp(0.0f);
+            }
+            m_curStep.store(e.step, std::memory_order_relaxed);
+        }
+        if (++m_seqPos < m_seq->period) return;
+
+        if (m_seqLoop.load(std::memory_order_relaxed)) {
+            m_seqPos = 0;
+            m_seqIdx = 0;
+        } else {
+            m_seqOn = false;
+            m_voice.setTargetAmp(0.0f);
+            m_curStep.store(-1, std::memory_order_relaxed);
+            m_seqDone.store(true, std::memory_order_relaxed);
+        }
+    }
+
     ToneGenerator* m_host;
-    int   m_sr = 44100;
-    int   m_rampSamples = 220;   // ~5ms @44.1k
-    float m_amp = 0.0f;
-    float m_targetAmp = 0.0f;
-    float m_volume = 0.85f;      // volume “lógico” (alvo da rampa ao ligar)
-    double m_phase = 0.0;
+    SineVoice m_voice;           // oscilador + rampa (compartilhado c/ o render offline)
+
+    // controles publicados pela GUI
+    std::atomic<float>    m_volume {0.85f};  // volume “lógico” (alvo da rampa ao ligar)
+    std::atomic<bool>     m_gateOn {false};
+    std::atomic<unsigned> m_gateSerial {0};  // cada gate() conta, mesmo repetido
+    unsigned            m_gateSeen = 0;      // lado áudio
+    float               m_blockVol = 0.85f;
+
+    std::atomic<qint64> m_probeFrame {-1};
+    std::atomic<bool>   m_probeArmed {false};
+
+    // sequenciador (lado áudio)
+    SeqProgram          m_seqSlots[2];
+    std::atomic<int>    m_seqState {0};
+    std::atomic<bool>   m_seqLoop {false};
+    std::atomic<bool>   m_seqDone {false};
+    std::atomic<int>    m_curStep {-1};
+    const SeqProgram*   m_seq = &m_seqSlots[0];
+    int                 m_seqIdx = 0;
+    qint64              m_seqPos = 0;
+    bool                m_seqOn = false;
+    bool                m_seqHzActive = false;
+    double              m_seqHz = 0.0;
 };
 
 // ===================== ToneGenerator ===============================
 ToneGenerator::ToneGenerator(QObject* parent)
     : QObject(parent)
 {
-    // cria o gerador; a sink é criada em ensureAudio()
+    // cria o gerador; ele entra no mix do AudioEngine em ensureAudio()/prewarm()
     m_sine = new SineStream(this);
+
+    m_probeTimer.setTimerType(Qt::PreciseTimer);
+    m_probeTimer.setInterval(2);
+    connect(&m_probeTimer, &QTimer::timeout, this, &ToneGenerator::pollLatencyProbe);
+
+    m_seqTimer.setInterval(15);
+    connect(&m_seqTimer, &QTimer::timeout, this, &ToneGenerator::pollSequence);
 }
 
 ToneGenerator::~ToneGenerator()
 {
     stop();
-    if (m_sink) { m_sink->stop(); m_sink->deleteLater(); m_sink = nullptr; }
-    if (m_sine) { m_sine->close(); delete m_sine; m_sine = nullptr; }
+    AudioEngine::shared().removeSource(m_sine);    // espera o callback largar a fonte
+    delete m_sine;
+    m_sine = nullptr;
 }
 
 // --------------------- API pública ---------------------------------
 void ToneGenerator::start()
 {
-    ensureAudio();                // cria sink e ajusta formato
-    if (!m_sink) return;
+    ensureAudio();                // no-op se já pré-aquecida (prewarm)
+    if (!isWarm()) return;
+    if (m_seqPlaying) stopSequence();
 
     // define frequência atual e abre o gate
     updateFrequency();
     updateLabel();
+    if (!m_playing) {
+        m_clickClock.start();
+        m_sine->armLatencyProbe();
+        m_probeTimer.start();
+    }
     m_sine->gate(true);
     m_playing = true;
     emit started();
 }
 
+void ToneGenerator::prewarm()
+{
+    // a sink fica rodando em silêncio (gate fechado) até o próximo start()
+    ensureAudio();
+}
+
+void ToneGenerator::releaseAudio()
+{
+    stop();
+    m_probeTimer.stop();
+    // sai do mix; a sink fecha quando ninguém mais a usa
+    AudioEngine::shared().removeSource(m_sine);
+}
+
+bool ToneGenerator::isWarm() const
+{
+    const AudioEngine& ae = AudioEngine::shared();
+    return ae.isOpen() && ae.hasSource(m_sine);
+}
+
+void ToneGenerator::setLatencyTargetMs(int ms)
+{
+    ms = qBound(10, ms, 200);
+    if (m_latencyMs == ms) return;
+    m_latencyMs = ms;
+
+    // o buffer é da sink compartilhada: ela é recriada e as fontes voltam sozinhas
+    if (isWarm()) AudioEngine::shared().setLatencyTargetMs(m_latencyMs);
+}
+
+void ToneGenerator::pollLatencyProbe()
+{
+    if (!isWarm() || !m_sine) { m_probeTimer.stop(); return; }
+
+    const qint64 frame = m_sine->probeFrame();
+    if (frame < 0) {
+        // gate fechado antes de soar: desiste da medição
+        if (!m_playing || m_clickClock.elapsed() > 2000) m_probeTimer.stop();
+        return;
+    }
+
+    // frames que o backend já consumiu (processedUSecs), não a estimativa
+    // interpolada de playedFrames(): essa parte do próprio alvo do buffer
+    if (AudioEngine::shared().deviceFrames() <= frame) return;
+
+    m_probeTimer.stop();
+    const double ms = m_clickClock.nsecsElapsed() / 1.0e6;
+    qInfo() << "[Tone] start -> 1o sample audivel:" << ms << "ms (buffer"
+            << AudioEngine::shared().latencyTargetMs() << "ms, meta" << kStartLatencyGoalMs << "ms)";
+    if (ms > kStartLatencyGoalMs)
+        qWarning() << "[Tone] latencia de start acima da meta";
+    emit startLatencyMeasured(ms);
+}
+
 void ToneGenerator::stop()
 {
+    if (m_seqPlaying) stopSequence();
     if (!m_playing) {
         // ainda assim feche o gate (silêncio suave)
         if (m_sine) m_sine->gate(false);
@@ -165,6 +345,132 @@ void ToneGenerator::setVolume(float vol01)
     if (m_sine) m_sine->setLogicalVolume(m_volume);
 }
 
+// --------------------- sequenciador --------------------------------
+void ToneGenerator::setSequence(const QVector<SequenceStep>& steps, double bpm)
+{
+    m_seqSteps = steps;
+    setSequenceTempo(bpm);
+}
+
+void ToneGenerator::setSequenceTempo(double bpm)
+{
+    m_seqBpm = qBound(20.0, bpm, 400.0);
+}
+
+void ToneGenerator::setSequenceArticulation(double ratio)
+{
+    m_seqArticulation = qBound(0.5, ratio, 1.0);
+}
+
+void ToneGenerator::setSequenceLoop(bool on)
+{
+    m_seqLoop = on;
+    if (m_sine) m_sine->setSeqLoop(on);   // vale já no ciclo atual
+}
+
+void ToneGenerator::startSequence()
+{
+    if (m_seqSteps.isEmpty()) return;
+    ensureAudio();
+    if (!isWarm()) return;
+
+    // timestamps em samples a partir da posição acumulada em tempos
+    // (arredonda cada fronteira, sem acumular erro de arredondamento)
+    const double spb = 60.0 / m_seqBpm * double(m_sampleRate);
+    QVector<SineStream::SeqEvent>& ev = m_sine->beginSequenceWrite();
+    double beat = 0.0;
+    for (int i = 0; i < m_seqSteps.size(); ++i) {
+        if (ev.size() + 2 > SineStream::kMaxSeqEvents) break;
+        const SequenceStep& st = m_seqSteps.at(i);
+        const qint64 at  = qint64(std::llround(beat * spb));
+        const qint64 len = qint64(std::llround((beat + st.beats) * spb)) - at;
+        beat += qMax(0.0, st.beats);
+        if (len <= 0) continue;
+
+        const double hz = (st.midi < 0) ? 0.0 : clampHz(freqFromMidi(st.midi));
+        ev.push_back({at, hz, i});
+        if (hz > 0.0 && m_seqArticulation < 1.0)
+            ev.push_back({at + qMax<qint64>(1, qint64(len * m_seqArticulation)), 0.0, i});
+    }
+    m_sine->setSeqLoop(m_seqLoop);
+    m_sine->commitSequence(qint64(std::llround(beat * spb)));
+
+    m_playing = false;            // a nota avulsa dá lugar ao exercício
+    m_seqPlaying = true;
+    m_seqLastStep = -1;
+    m_seqTimer.start();
+    emit started();
+}
+
+void ToneGenerator::stopSequence()
+{
+    if (!m_seqPlaying) return;
+    m_seqPlaying = false;
+    m_seqTimer.stop();
+    if (m_sine) {
+        m_sine->beginSequenceWrite();
+        m_sine->commitSequence(0);    // programa vazio: callback para de avançar
+        m_sine->gate(false);
+    }
+    if (m_seqLastStep != -1) {
+        m_seqLastStep = -1;
+        emit sequenceStepChanged(-1, -1);
+    }
+    emit stopped();
+}
+
+void ToneGenerator::pollSequence()
+{
+    if (!m_sine) return;
+    const int step = m_sine->currentStep();
+    if (step != m_seqLastStep) {
+        m_seqLastStep = step;
+        const int midi = (step >= 0 && step < m_seqSteps.size()) ? m_seqSteps.at(step).midi : -1;
+        emit sequenceStepChanged(step, midi);
+    }
+    if (m_sine->sequenceDone()) {
+        m_seqPlaying = false;
+        m_seqTimer.stop();
+        emit sequenceFinished();
+        emit stopped();
+    }
+}
+
+QVector<ToneGenerator::SequenceStep> ToneGenerator::majorScale(int rootMidi, int octaves, double beats)
+{
+    static const int degrees[7] = {0, 2, 4, 5, 7, 9, 11};
+    octaves = qBound(1, octaves, 3);
+    QVector<SequenceStep> up;
+    for (int o = 0; o < octaves; ++o)
+        for (int d : degrees) up.push_back({rootMidi + 12*o + d, beats});
+    up.push_back({rootMidi + 12*octaves, beats});
+
+    // sobe e desce sem repetir o topo
+    QVector<SequenceStep> seq = up;
+    for (int i = up.size() - 2; i >= 0; --i) seq.push_back(up.at(i));
+    return seq;
+}
+
+QVector<ToneGenerator::SequenceStep> ToneGenerator::arpeggio(int rootMidi, bool minor, double beats)
+{
+    const int third = minor ? 3 : 4;
+    return { {rootMidi, beats}, {rootMidi + third, beats}, {rootMidi + 7, beats},
+             {rootMidi + 12, beats}, {rootMidi + 7, beats}, {rootMidi + third, beats},
+             {rootMidi, beats} };
+}
+
+QVector<ToneGenerator::SequenceStep> ToneGenerator::intervalPairs(int rootMidi, const QVector<int>& semitones,
+                                                                 double beats)
+{
+    QVector<SequenceStep> seq;
+    for (int iv : semitones) {
+        seq.push_back({rootMidi, beats});
+        seq.push_back({rootMidi + iv, beats});
+        seq.push_back({-1, beats});   // respiro entre os pares
+    }
+    return seq;
+}
+
 // --------------------- helpers -------------------------------------
 QString ToneGenerator::noteLabel() const
 {
@@ -209,8 +515,7 @@ void ToneGenerator::updateFrequency()
     const int midi = midiFromNote(m_noteIndex, m_acc, m_octave);
     double hz = freqFromMidi(midi);
 
-    // Clamps suaves para speaker de celular (~80..6000 Hz)
-    hz = qBound(80.0, hz, qMin(6000.0, 0.45 * m_sampleRate)); // respeita Nyquist
+    hz = clampHz(hz);
 
     m_freqHz.store(hz, std::memory_order_relaxed);
     emit frequencyChanged(hz);
@@ -218,6 +523,12 @@ void ToneGenerator::updateFrequency()
     // Se já está tocando, não precisa reiniciar a sink—o gerador usa a nova f instantaneamente
 }
 
+double ToneGenerator::clampHz(double hz) const
+{
+    // Clamps suaves para speaker de celular (~80..6000 Hz)
+    return qBound(80.0, hz, qMin(6000.0, 0.45 * m_sampleRate)); // respeita Nyquist
+}
+
 void ToneGenerator::setTargetAmplitude(float a)
 {
     if (m_sine) {
@@ -227,18 +538,13 @@ void ToneGenerator::setTargetAmplitude(float a)
 
 void ToneGenerator::ensureAudio()
 {
-    if (m_sink && m_stream) return;
+    if (isWarm()) return;
 
-    QAudioDevice dev = QMediaDevices::defaultAudioOutput();
-    QAudioFormat fmt;
-    fmt.setSampleRate(m_sampleRate);
-    fmt.setChannelCount(1);
-    fmt.setSampleFormat(QAudioFormat::Int16);
-    if (!dev.isFormatSupported(fmt)) {
-        fmt = dev.preferredFormat();
-    }
-    m_fmt = fmt;
-    m_sampleRate = m_fmt.sampleRate();
+    // uma sink só para o app: o drone e o metrônomo somam no mesmo mix
+    AudioEngine& ae = AudioEngine::shared();
+    if (!ae.isOpen()) ae.setLatencyTargetMs(m_latencyMs);   // aberta pelo metrônomo: mantém
+    if (!ae.open()) return;
+    m_sampleRate = ae.sampleRate();
 
     // Ajusta limites de oitava baseado no sample rate
     // (C2 ≈ 65 Hz, C7 ≈ 2093 Hz, C8 ≈ 4186 Hz)
@@ -246,15 +552,6 @@ void ToneGenerator::ensureAudio()
     m_maxOctave = 7;
     if (m_sampleRate < 32000) m_maxOctave = 6;
 
-    // (re)cria a sink
-    if (m_sink) { m_sink->stop(); m_sink->deleteLater(); m_sink = nullptr; }
-    m_sink = new QAudioSink(dev, m_fmt, this);
-    m_sink->setVolume(1.0f);
-
-    m_sine->setSampleRate(m_sampleRate);
-    m_sine->setVolume(m_volume);
-
-    // PULL MODE: a sink puxa dados do seu QIODevice gerador
-    m_sink->start(m_sine);
-    m_stream = nullptr; // não usado em pull mode
+    m_sine->setLogicalVolume(m_volume); // não abre o gate (prewarm fica em silêncio)
+    ae.addSource(m_sine);               // prepare(): voz na taxa do stream
 }
@@ -1,12 +1,10 @@
 #pragma once
 #include <QObject>
-#include <QAudioFormat>
 #include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
 #include <atomic>
 
-class QAudioSink;
-class QIODevice;
-
 class ToneGenerator : public QObject
 {
     Q_OBJECT
@@ -22,6 +20,17 @@ public:
     Q_INVOKABLE void stop();            // para de tocar
     Q_INVOKABLE bool isPlaying() const { return m_playing; }
 
+    // Baixa latência: entra no mix do AudioEngine (sink única do app) e
+    // fica rodando em silêncio; depois disso start()/stop() só abrem/fecham
+    // o gate do gerador.
+    Q_INVOKABLE void prewarm();
+    Q_INVOKABLE void releaseAudio();    // sai do mix (volta ao estado "frio")
+    bool isWarm() const;
+
+    // Alvo de latência (ms) usado para dimensionar o buffer da sink comum
+    void setLatencyTargetMs(int ms);    // 10..200, default 30
+    int  latencyTargetMs() const { return m_latencyMs; }
+
     // Nota base (0..6) => C, D, E, F, G, A, B
     void setNoteIndex(int idx);         // 0=C,1=D,...,6=B
     int  noteIndex() const { return m_noteIndex; }
@@ -43,6 +52,26 @@ public:
     void setVolume(float vol01);
     float volume() const { return m_volume; }
 
+    // Sequenciador (exercícios: escalas, arpejos, intervalos) com fronteiras
+    // de nota exatas no sample — consumido dentro do callback de áudio
+    struct SequenceStep {
+        int    midi  = 69;              // < 0 => pausa
+        double beats = 1.0;             // duração em tempos
+    };
+    void setSequence(const QVector<SequenceStep>& steps, double bpm);
+    void setSequenceTempo(double bpm);  // vale no próximo startSequence()
+    void setSequenceArticulation(double ratio); // 0.5..1.0 (1.0 = legato)
+    void setSequenceLoop(bool on);
+    bool sequenceLoop() const { return m_seqLoop; }
+    bool isSequencePlaying() const { return m_seqPlaying; }
+    void startSequence();
+    void stopSequence();
+
+    static QVector<SequenceStep> majorScale(int rootMidi, int octaves = 1, double beats = 1.0);
+    static QVector<SequenceStep> arpeggio(int rootMidi, bool minor = false, double beats = 1.0);
+    static QVector<SequenceStep> intervalPairs(int rootMidi, const QVector<int>& semitones,
+                                               double beats = 1.0);
+
     // Informações da nota/frequência atual
     double frequency() const { return m_freqHz; }
     QString noteLabel() const;          // "C#4" ou "Db4" conforme o acidente setado
@@ -53,12 +82,22 @@ signals:
     void started();
     void stopped();
 
+    // Passo do sequenciador que está soando (-1 = nenhum)
+    void sequenceStepChanged(int step, int midi);
+    void sequenceFinished();
+
+    // Latência medida entre o start() e o 1º sample audível consumido pelo device
+    void startLatencyMeasured(double ms);
+
 private:
     // Áudio
-    void ensureAudio();              // cria/ajusta QAudioSink
+    void ensureAudio();              // abre o AudioEngine e entra no mix
     void updateFrequency();          // recalcula freq e envia ao gerador
     void updateLabel();              // emite rótulo da nota
     void setTargetAmplitude(float a);// rampa de amplitude
+    void pollLatencyProbe();         // confere se o 1º sample audível já foi consumido
+    void pollSequence();             // repassa o passo atual do sequenciador à UI
+    double clampHz(double hz) const; // limites do speaker/Nyquist
 
 private:
     // Mapeamentos
@@ -77,11 +116,23 @@ private:
     int         m_minOctave  = 0;
     int         m_maxOctave  = 8;
 
-    // Áudio
-    QAudioSink* m_sink       = nullptr;
-    QIODevice*  m_stream     = nullptr; // gerador (QIODevice) usado pela sink
-    QAudioFormat m_fmt;
+    // Áudio (a sink é do AudioEngine)
     int         m_sampleRate = 44100;
+    int         m_latencyMs  = 30;      // alvo p/ o tamanho do buffer da sink
+
+    // Medição click -> 1º sample audível
+    static constexpr double kStartLatencyGoalMs = 50.0;
+    QElapsedTimer m_clickClock;
+    QTimer      m_probeTimer;
+
+    // Sequenciador (lado GUI)
+    QVector<SequenceStep> m_seqSteps;
+    double      m_seqBpm          = 80.0;
+    double      m_seqArticulation = 0.85;
+    bool        m_seqLoop         = false;
+    bool        m_seqPlaying      = false;
+    int         m_seqLastStep     = -1;
+    QTimer      m_seqTimer;
 
     // Sinal senoidal (estado de execução)
     std::atomic<double> m_freqHz {0.0};
@@ -0,0 +1,207 @@
+// musicool-render: gera drones e trilhas de metrônomo em WAV, mais rápido
+// que o tempo real e sem device de áudio.
+//
+//   musicool-render drone --note A4 --seconds 600 -o la4.wav
+//   musicool-render click --bpm 70 --beats 3 --seconds 600 -o click70.wav
+//   musicool-render click --bpm 60 --beats 2 --poly 3 -o tres-contra-dois.wav
+//   musicool-render click --bpm 90 --sound woodblock -o woodblock90.wav
+//   musicool-render measure            (precisão do metrônomo, 10 min por BPM)
+
+#include "audiosynth.h"
+#include "clickbank.h"
+#include "metronomeengine.h"
+#include "metronomemeasure.h"
+#include "wavfile.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QVector>
+
+static constexpr int kBlockFrames = 4096;
+
+// "A4", "C#3", "Bb2" → MIDI (C-1 = 0); -1 se inválido
+static int midiFromName(const QString& name)
+{
+    static const QRegularExpression re(QStringLiteral("^([A-Ga-g])([#b]?)(-?\\d+)$"));
+    const QRegularExpressionMatch m = re.match(name.trimmed());
+    if (!m.hasMatch()) return -1;
+
+    static const int semi[7] = {9, 11, 0, 2, 4, 5, 7}; // A B C D E F G
+    int s = semi[m.captured(1).toUpper().at(0).unicode() - 'A'];
+    if (m.captured(2) == QLatin1String("#")) ++s;
+    if (m.captured(2) == QLatin1String("b")) --s;
+    return (m.captured(3).toInt() + 1) * 12 + s;
+}
+
+static bool renderDrone(WavWriter& wav, int sr, qint64 frames, double hz, float volume)
+{
+    SineVoice voice;
+    voice.setSampleRate(sr);
+    voice.setTargetAmp(volume);
+
+    const qint64 fadeOut = qMax(1, sr / 200); // mesma rampa de ~5 ms do app
+    QVector<qint16> buf(kBlockFrames);
+    for (qint64 pos = 0; pos < frames; ) {
+        const int n = int(qMin<qint64>(kBlockFrames, frames - pos));
+        for (int i = 0; i < n; ++i) {
+            if (pos + i == frames - fadeOut) voice.setTargetAmp(0.0f);
+            buf[i] = SineVoice::toInt16(voice.next(hz));
+        }
+        if (!wav.write(buf.constData(), n)) return false;
+        pos += n;
+    }
+    return true;
+}
+
+static bool renderClicks(WavWriter& wav, int sr, qint64 frames, double bpm,
+                         const BeatPattern& pattern, double downHz, double upHz,
+                         const QVector<int>& poly, const ClickBank& bank, int sound)
+{
+    // mesmos clicks do MetronomeWidget::prepareClicks() e o mesmo
+    // agendamento por sample do app (MetronomeEngine)
+    MetronomeEngine engine;
+    engine.setSampleRate(sr);
+    if (sound >= 0)
+        engine.setClicks(bank.accent(sound), bank.normal(sound), bank.subdivision(sound));
+    else
+        engine.setClicks(genClick(sr, downHz, 40, 0.95f), genClick(sr, upHz, 32, 0.85f),
+                         genClick(sr, upHz, 20, 0.45f));
+    engine.setBpm(bpm);
+    engine.setPattern(pattern);
+
+    // camadas de polirritmia com os timbres do widget (1400 / 2200 Hz)
+    static const double layerHz[] = {1400.0, 2200.0};
+    static const float  layerGain[] = {0.8f, 0.7f};
+    QVector<RhythmLayer> layers;
+    for (int l = 0; l < poly.size() && l < MetronomeEngine::kLayers - 1; ++l) {
+        RhythmLayer r;
+        r.pulses = poly.at(l);
+        r.click  = genClick(sr, layerHz[l], 24, 0.8f);
+        r.gain   = layerGain[l];
+        layers.append(r);
+    }
+    engine.setLayers(layers);
+    engine.start();
+
+    QVector<qint16> buf(kBlockFrames);
+    for (qint64 pos = 0; pos < frames; ) {
+        const int n = int(qMin<qint64>(kBlockFrames, frames - pos));
+        engine.render(buf.data(), n);
+        if (!wav.write(buf.constData(), n)) return false;
+        pos += n;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("musicool-render");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Render offline de drones e trilhas de metronomo (WAV 16-bit mono).");
+    p.addHelpOption();
+    p.addPositionalArgument("mode", "drone | click | measure");
+    const QCommandLineOption optOut({"o", "output"}, "Arquivo WAV de saida.", "file");
+    const QCommandLineOption optSecs("seconds", "Duracao em segundos (default 600).", "s", "600");
+    const QCommandLineOption optRate("rate", "Sample rate (default 48000).", "hz", "48000");
+    const QCommandLineOption optNote("note", "Nota do drone, ex.: A4, C#3, Bb2 (default A4).", "name", "A4");
+    const QCommandLineOption optHz("hz", "Frequencia do drone (sobrepoe --note).", "hz");
+    const QCommandLineOption optVol("volume", "Volume 0..1 (default 0.85).", "v", "0.85");
+    const QCommandLineOption optBpm("bpm", "Andamento do click (default 120).", "bpm", "120");
+    const QCommandLineOption optBeats("beats", "Tempos por compasso (default 4).", "n", "4");
+    const QCommandLineOption optMeter("meter", "Formula de compasso, ex.: 5/4, 6/8, 12/8 (sobrepoe --beats).", "n/d");
+    const QCommandLineOption optSub("subdivision", "Pulsos por tempo: 1, 2, 3 ou 4 (default 1).", "n", "1");
+    const QCommandLineOption optSwing("swing", "Swing 0..1 (default 0).", "s", "0");
+    const QCommandLineOption optNoAcc("no-accent", "Sem acento no 1o tempo.");
+    const QCommandLineOption optDown("down-hz", "Frequencia do click do 1o tempo (default 500).", "hz", "500");
+    const QCommandLineOption optUp("up-hz", "Frequencia dos demais clicks (default 900).", "hz", "900");
+    const QCommandLineOption optPoly("poly", "Polirritmia: pulsos por compasso das camadas extras, ex.: 3 ou 3,5.", "n[,m]");
+    const QCommandLineOption optSound("sound", "Som do click: " + ClickBank::names().join(", ")
+                                      + " (default: senoide).", "name");
+    const QCommandLineOption optBuf("buffer-ms", "measure: buffer simulado da sink (default 40).", "ms", "40");
+    p.addOptions({optOut, optSecs, optRate, optNote, optHz, optVol,
+                  optBpm, optBeats, optMeter, optSub, optSwing, optNoAcc,
+                  optDown, optUp, optPoly, optSound, optBuf});
+    p.process(app);
+
+    const QStringList args = p.positionalArguments();
+    const QString mode = args.value(0);
+    if (mode == "measure") {
+        return runMetronomeMeasure(out, qBound(8000, p.value(optRate).toInt(), 192000),
+                                   qMax(1.0, p.value(optSecs).toDouble()),
+                                   qMax(0.0, p.value(optBuf).toDouble()));
+    }
+    if ((mode != "drone" && mode != "click") || !p.isSet(optOut)) {
+        err << p.helpText();
+        return 2;
+    }
+
+    const int    sr     = qBound(8000, p.value(optRate).toInt(), 192000);
+    const double secs   = qMax(0.0, p.value(optSecs).toDouble());
+    const qint64 frames = qint64(std::llround(secs * sr));
+
+    WavWriter wav;
+    if (!wav.open(p.value(optOut), sr, 1)) {
+        err << "nao foi possivel criar " << p.value(optOut) << ": " << wav.errorString() << "\n";
+        return 1;
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+
+    bool ok = false;
+    if (mode == "drone") {
+        double hz = p.value(optHz).toDouble();
+        if (!p.isSet(optHz)) {
+            const int midi = midiFromName(p.value(optNote));
+            if (midi < 0) { err << "nota invalida: " << p.value(optNote) << "\n"; return 2; }
+            hz = 440.0 * std::pow(2.0, (midi - 69) / 12.0);
+        }
+        hz = qBound(20.0, hz, 0.45 * sr);
+        const float vol = qBound(0.0f, p.value(optVol).toFloat(), 1.0f);
+        ok = renderDrone(wav, sr, frames, hz, vol);
+    } else {
+        const double bpm    = qBound(30.0, p.value(optBpm).toDouble(), 300.0);
+        const bool   accent = !p.isSet(optNoAcc);
+        const int    sub    = p.value(optSub).toInt();
+        BeatPattern pattern = BeatPattern::simple(p.value(optBeats).toInt(), sub, accent);
+        if (p.isSet(optMeter)) {
+            const QStringList nd = p.value(optMeter).split('/');
+            pattern = BeatPattern::timeSignature(nd.value(0).toInt(), nd.value(1).toInt(), sub, accent);
+        }
+        pattern.swing = p.value(optSwing).toDouble();
+        QVector<int> poly;
+        for (const QString& n : p.value(optPoly).split(',', Qt::SkipEmptyParts))
+            if (n.toInt() > 0) poly.append(qMin(n.toInt(), 16));
+        ClickBank bank;
+        int sound = -1;
+        if (p.isSet(optSound)) {
+            bank.load(sr);
+            sound = bank.indexOf(p.value(optSound));
+            if (sound < 0) { err << "som invalido: " << p.value(optSound) << "\n"; return 2; }
+        }
+        ok = renderClicks(wav, sr, frames, bpm, pattern,
+                          p.value(optDown).toDouble(), p.value(optUp).toDouble(), poly,
+                          bank, sound);
+    }
+    ok = wav.close() && ok;
+
+    const double elapsed = clock.nsecsElapsed() / 1.0e9;
+    if (!ok) {
+        err << "falha ao gravar " << p.value(optOut) << "\n";
+        return 1;
+    }
+    out << QString("%1 s de audio em %2 s (%3x tempo real) -> %4\n")
+               .arg(secs, 0, 'f', 1)
+               .arg(elapsed, 0, 'f', 3)
+               .arg(elapsed > 0.0 ? secs / elapsed : 0.0, 0, 'f', 0)
+               .arg(p.value(optOut));
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "metronomemeasure.h"
+#include "audiosynth.h"
+#include "metronomeengine.h"
+
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int kMinBlock  = 64;
+constexpr int kMaxBlock  = 2048;
+constexpr double kUiPollMs = 5.0;    // intervalo do QTimer de UI do widget
+constexpr int kDevicePeriod = 256;   // o device consome a fila em períodos
+
+// "Sink" de captura: detecta o início de cada click (1º sample não nulo
+// depois de pelo menos 10 ms de silêncio)
+struct CaptureSink
+{
+    explicit CaptureSink(int sr) : minGap(sr / 100) {}
+
+    void consume(const qint16* x, int n, qint64 pos0) {
+        for (int i = 0; i < n; ++i) {
+            if (x[i] == 0) { ++silent; continue; }
+            if (silent >= minGap) onsets.push_back(pos0 + i);
+            silent = 0;
+        }
+    }
+
+    QVector<qint64> onsets;
+    qint64 silent = 1 << 30;
+    int    minGap;
+};
+
+struct Result
+{
+    int    onsets    = 0;
+    double ppm       = 0.0;   // erro médio de andamento
+    double jitterStd = 0.0;   // µs
+    double jitterP99 = 0.0;   // µs (|desvio| do intervalo ideal)
+    double driftMs   = 0.0;   // última batida vs grade ideal
+    double legacyMs  = 0.0;   // deriva do QTimer antigo (int ms) no mesmo tempo
+    double gapMean   = 0.0;   // luz acesa no render - click audível (ms; < 0 = adiantada)
+    double gapMin    = 0.0;
+    double gapMax    = 0.0;
+    double heardMean = 0.0;   // luz pelo relógio do áudio (MetronomeWidget) - click
+    double heardMin  = 0.0;
+    double heardMax  = 0.0;
+    quint64 truncated = 0;    // clicks cortados antes do fim (MetronomeEngine::Stats)
+};
+
+void summarize(const QVector<double>& v, double* mean, double* mn, double* mx)
+{
+    if (v.isEmpty()) return;
+    *mn = *std::min_element(v.begin(), v.end());
+    *mx = *std::max_element(v.begin(), v.end());
+    double s = 0.0;
+    for (double g : v) s += g;
+    *mean = s / v.size();
+}
+
+Result measure(int sr, double bpm, double seconds, double bufferMs)
+{
+    MetronomeEngine engine;
+    engine.setSampleRate(sr);
+    engine.setClicks(genClick(sr, 500.0, 40, 0.95f), genClick(sr, 900.0, 32, 0.85f),
+                     genClick(sr, 900.0, 20, 0.45f));
+    engine.setBpm(bpm);
+    engine.setPattern(BeatPattern::simple(4));
+    engine.start();
+
+    CaptureSink cap(sr);
+    QVector<qint16> buf(kMaxBlock);
+    QVector<double> gaps, heardGaps;
+
+    const qint64 frames = qint64(seconds * sr);
+    const double latency = bufferMs / 1000.0 * sr; // frames na fila da sink
+    quint32 rng = 0x2545F491u;
+    quint64 cursor = engine.beatCursor();
+    QVector<qint64> pending;
+    MetronomeEngine::BeatEvent ev[32];
+
+    // relógio de parede em passos do timer de UI; a sink mantém `latency`
+    // frames renderizados à frente do que está tocando
+    qint64 pos = 0;
+    for (double t = 0.0; ; t += kUiPollMs) {
+        const double now = t * sr / 1000.0;
+        if (now >= frames) break;
+        while (pos < frames && pos < now + latency) {
+            rng = rng * 1664525u + 1013904223u;     // tamanhos de bloco variados
+            const int n = int(qMin<qint64>(kMinBlock + int(rng >> 8) % (kMaxBlock - kMinBlock + 1),
+                                           frames - pos));
+            engine.render(buf.data(), n);
+            cap.consume(buf.constData(), n, pos);
+            pos += n;
+        }
+
+        // antigo: acende assim que o pulso é renderizado
+        for (int n; (n = engine.readBeats(&cursor, ev, 32)) > 0; )
+            for (int i = 0; i < n; ++i) {
+                gaps.push_back(t - double(ev[i].at) * 1000.0 / sr);
+                pending.push_back(ev[i].at);
+            }
+
+        // widget: acende quando renderizado - fila da sink alcança o pulso
+        const qint64 played = qint64(now) / kDevicePeriod * kDevicePeriod;
+        const qint64 queued = pos - played;
+        const qint64 heard  = pos - queued;
+        int shown = 0;
+        while (shown < pending.size() && pending.at(shown) <= heard)
+            heardGaps.push_back(t - double(pending.at(shown++)) * 1000.0 / sr);
+        pending.remove(0, shown);
+    }
+
+    Result r;
+    const QVector<qint64>& on = cap.onsets;
+    r.onsets = int(on.size());
+    if (on.size() < 3) return r;
+
+    const double ideal = 60.0 / bpm * sr;
+    const int    intervals = int(on.size()) - 1;
+    const double mean = double(on.last() - on.first()) / intervals;
+    r.ppm = (mean - ideal) / ideal * 1.0e6;
+
+    QVector<double> dev;
+    dev.reserve(intervals);
+    double acc = 0.0, acc2 = 0.0;
+    for (int i = 1; i < on.size(); ++i) {
+        const double d = double(on[i] - on[i - 1]) - ideal;
+        dev.push_back(std::abs(d));
+        acc += d; acc2 += d * d;
+    }
+    const double m = acc / intervals;
+    r.jitterStd = std::sqrt(qMax(0.0, acc2 / intervals - m * m)) * 1.0e6 / sr;
+    std::sort(dev.begin(), dev.end());
+    r.jitterP99 = dev[qMin(intervals - 1, int(std::ceil(0.99 * intervals)) - 1)] * 1.0e6 / sr;
+
+    r.driftMs  = (double(on.last() - on.first()) - intervals * ideal) * 1000.0 / sr;
+    r.legacyMs = intervals * (int(60000.0 / bpm) - 60000.0 / bpm);
+
+    r.truncated = engine.stats().truncatedClicks;
+    summarize(gaps, &r.gapMean, &r.gapMin, &r.gapMax);
+    summarize(heardGaps, &r.heardMean, &r.heardMin, &r.heardMax);
+    return r;
+}
+
+} // namespace
+
+int runMetronomeMeasure(QTextStream& out, int sampleRate, double seconds, double bufferMs)
+{
+    static const double bpms[] = {30.0, 70.0, 120.0, 240.0, 300.0};
+
+    out << QString("MetronomeEngine @ %1 Hz, %2 s, blocos %3..%4, buffer da sink %5 ms\n")
+               .arg(sampleRate).arg(seconds, 0, 'f', 0)
+               .arg(kMinBlock).arg(kMaxBlock).arg(bufferMs, 0, 'f', 1);
+    out << "  BPM  onsets  erro(ppm)  jitter-std(us)  jitter-p99(us)  deriva(ms)"
+           "  deriva-QTimer-antigo(ms)  luz-click no render / pelo audio"
+           " media/min/max(ms)  cortados\n";
+
+    int failures = 0;
+    for (double bpm : bpms) {
+        const Result r = measure(sampleRate, bpm, seconds, bufferMs);
+        const int expected = int(seconds * bpm / 60.0) + 1;
+        if (r.onsets < expected - 1) ++failures; // click perdido/fundido
+        if (r.truncated > 0) ++failures;
+
+        out << QString("%1  %2  %3  %4  %5  %6  %7  %8/%9/%10  %11/%12/%13  %14\n")
+                   .arg(bpm, 5, 'f', 0)
+                   .arg(r.onsets, 6)
+                   .arg(r.ppm, 9, 'f', 3)
+                   .arg(r.jitterStd, 14, 'f', 2)
+                   .arg(r.jitterP99, 14, 'f', 2)
+                   .arg(r.driftMs, 10, 'f', 3)
+                   .arg(r.legacyMs, 24, 'f', 1)
+                   .arg(r.gapMean, 0, 'f', 1)
+                   .arg(r.gapMin, 0, 'f', 1)
+                   .arg(r.gapMax, 0, 'f', 1)
+                   .arg(r.heardMean, 0, 'f', 1)
+                   .arg(r.heardMin, 0, 'f', 1)
+                   .arg(r.heardMax, 0, 'f', 1)
+                   .arg(r.truncated);
+    }
+    out.flush();
+    return failures == 0 ? 0 : 1;
+}
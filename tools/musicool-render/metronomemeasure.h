@@ -0,0 +1,8 @@
+#pragma once
+#include <QTextStream>
+
+// Mede a precisão do MetronomeEngine: renderiza em blocos de tamanho
+// variável (como os pulls de uma sink), detecta os onsets dos clicks no
+// áudio capturado e reporta erro de andamento, jitter e deriva, além da
+// distância entre o tick da UI e o click audível.
+int runMetronomeMeasure(QTextStream& out, int sampleRate, double seconds, double bufferMs);
@@ -0,0 +1,27 @@
+# Render offline (sem device de áudio) de drones e trilhas de clique em WAV,
+# usando o mesmo código de síntese do app.
+QT       = core
+CONFIG  += console c++17
+CONFIG  -= app_bundle
+
+TARGET = musicool-render
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    metronomemeasure.cpp \
+    ../../audiosynth.cpp \
+    ../../clickbank.cpp \
+    ../../metronomeengine.cpp \
+    ../../wavfile.cpp
+
+HEADERS += \
+    metronomemeasure.h \
+    ../../audiosynth.h \
+    ../../clickbank.h \
+    ../../metronomeengine.h \
+    ../../wavfile.h
+
+# sons de click do banco (sounds/*.wav)
+RESOURCES += ../../stuff.qrc
@@ -0,0 +1,185 @@
+// musicool-widgetbench: mede quanto custa desenhar os widgets do app. Cada
+// widget é renderizado offscreen numa QImage via QWidget::render, nos
+// tamanhos/DPRs de phone, tablet e desktop 4K, passando por estados
+// representativos (varredura de cents, cada nota MIDI, cada pulso), e o
+// tempo por frame sai em percentis.
+//
+//   musicool-widgetbench                      (todos os perfis)
+//   musicool-widgetbench --profile tablet     (um perfil)
+//   musicool-widgetbench --repeat 5           (renders por estado, default 3)
+//
+// O DPR vem de QT_SCALE_FACTOR, que só vale antes da QApplication: sem
+// --profile o processo roda um filho por perfil.
+
+#include "metronomewidget.h"
+#include "staffnotewidget.h"
+#include "tunerwidget.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QProcess>
+#include <QTextStream>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+struct Profile {
+    const char* name;
+    double dpr;
+    int    width;                         // lógico
+};
+static const Profile kProfiles[] = {
+    {"phone",     2.75,  392},            // retrato, ~1080 px
+    {"tablet",    2.0,   800},
+    {"desktop4k", 2.0,  1920},            // 3840 px
+};
+
+static const Profile* findProfile(const QString& name)
+{
+    for (const Profile& p : kProfiles)
+        if (name == QLatin1String(p.name)) return &p;
+    return nullptr;
+}
+
+// tempo de cada render; state(i) prepara o i-ésimo estado antes de medir
+static QVector<qint64> measure(QWidget& w, int states, int repeat,
+                               const std::function<void(int)>& state)
+{
+    const qreal dpr = w.devicePixelRatioF();
+    QImage img((QSizeF(w.size()) * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+    img.setDevicePixelRatio(dpr);
+
+    QVector<qint64> ns;
+    ns.reserve(states * repeat);
+    for (int i = 0; i < states; ++i) {
+        state(i);
+        for (int r = 0; r < repeat; ++r) {
+            QElapsedTimer t;
+            t.start();
+            w.render(&img);
+            ns.append(t.nsecsElapsed());
+        }
+    }
+    return ns;
+}
+
+static void report(QTextStream& out, const QString& what, QVector<qint64> ns)
+{
+    if (ns.isEmpty()) return;
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p){ return ns.at(qMin(ns.size() - 1, int(p * ns.size()))) / 1000.0; };
+    double sum = 0.0;
+    for (qint64 v : ns) sum += v;
+    out << QStringLiteral("  %1 %2 frames  media %3  p50 %4  p90 %5  p99 %6  max %7 us\n")
+               .arg(what, -22).arg(ns.size(), 5)
+               .arg(sum / ns.size() / 1000.0, 8, 'f', 1)
+               .arg(pct(0.50), 8, 'f', 1).arg(pct(0.90), 8, 'f', 1)
+               .arg(pct(0.99), 8, 'f', 1).arg(ns.last() / 1000.0, 8, 'f', 1);
+    out.flush();
+}
+
+static int runProfile(QTextStream& out, const Profile& pf, int repeat)
+{
+    out << QStringLiteral("%1: %2 px lógicos @%3 (DPR efetivo %4)\n")
+               .arg(pf.name).arg(pf.width).arg(pf.dpr)
+               .arg(qApp->devicePixelRatio());
+
+    // afinador: varredura de -50..+50 cents com e sem a camada estática
+    // em cache, e troca de nota (refaz a camada)
+    {
+        TunerWidget w;
+        w.resize(pf.width, 180);
+        w.ensurePolished();
+        w.setAnimationEnabled(false);
+        for (bool cache : {true, false}) {
+            w.setStaticCacheEnabled(cache);
+            report(out, cache ? "tuner cents (cache)" : "tuner cents (sem cache)",
+                   measure(w, 101, repeat, [&](int i){ w.setDisplayCents(i - 50.0); }));
+        }
+        w.setStaticCacheEnabled(true);
+        report(out, "tuner notas 0..127",
+               measure(w, 128, repeat, [&](int i){ w.setBaseMidi(i); }));
+    }
+
+    // pauta: cada nota MIDI, sustenidos e bemóis
+    {
+        StaffNoteWidget w;
+        w.resize(pf.width, 200);
+        w.ensurePolished();
+        w.setClefImageFile(":/sol.png");
+        report(out, "staff notas (#)", measure(w, 128, repeat, [&](int i){
+            w.setMidi(i, StaffNoteWidget::AccPref::Sharps); }));
+        report(out, "staff notas (b)", measure(w, 128, repeat, [&](int i){
+            w.setMidi(i, StaffNoteWidget::AccPref::Flats); }));
+    }
+
+    // metrônomo: cada pulso de padrões simples, compostos e com camadas
+    {
+        MetronomeWidget w;
+        w.setAudioEnabled(false);
+        w.resize(pf.width, 220);
+        w.ensurePolished();
+
+        w.setBeatsPerMeasure(4);
+        report(out, "metro 4/4", measure(w, 4, repeat, [&](int i){ w.setDisplayedPulse(i); }));
+
+        w.setTimeSignature(12, 8);
+        report(out, "metro 12/8", measure(w, w.pattern().pulses(), repeat,
+                                          [&](int i){ w.setDisplayedPulse(i); }));
+
+        w.setTimeSignature(4, 4);
+        w.setSubdivision(4);
+        w.setPolyrhythm({3, 5});
+        report(out, "metro 4/4 x4 + 3:5", measure(w, w.pattern().pulses(), repeat,
+                                                  [&](int i){ w.setDisplayedPulse(i); }));
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // perfil e DPR antes da QApplication (QT_SCALE_FACTOR é lido no início)
+    const Profile* profile = nullptr;
+    for (int i = 1; i + 1 < argc; ++i)
+        if (qstrcmp(argv[i], "--profile") == 0) profile = findProfile(QString::fromLocal8Bit(argv[i + 1]));
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    if (profile)
+        qputenv("QT_SCALE_FACTOR", QByteArray::number(profile->dpr));
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("musicool-widgetbench");
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser p;
+    p.setApplicationDescription("Benchmark de desenho dos widgets (offscreen, QWidget::render).");
+    p.addHelpOption();
+    const QCommandLineOption optProfile("profile", "phone | tablet | desktop4k (default: todos).", "name");
+    const QCommandLineOption optRepeat("repeat", "Renders por estado (default 3).", "n", "3");
+    p.addOptions({optProfile, optRepeat});
+    p.process(app);
+
+    const int repeat = qBound(1, p.value(optRepeat).toInt(), 100);
+    if (p.isSet(optProfile)) {
+        if (!profile) { err << p.helpText(); return 2; }
+        return runProfile(out, *profile, repeat);
+    }
+
+    // um filho por perfil (cada um com seu QT_SCALE_FACTOR)
+    int rc = 0;
+    for (const Profile& pf : kProfiles) {
+        QProcess child;
+        child.setProcessChannelMode(QProcess::ForwardedChannels);
+        child.start(QCoreApplication::applicationFilePath(),
+                    {"--profile", QString::fromLatin1(pf.name), "--repeat", QString::number(repeat)});
+        if (!child.waitForFinished(-1) || child.exitCode() != 0) {
+            err << "falhou: " << pf.name << "\n";
+            rc = 1;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,35 @@
+# Benchmark de desenho dos widgets do app, offscreen (QWidget::render numa
+# QImage), em tamanhos/DPRs de phone, tablet e desktop 4K.
+QT      += widgets multimedia
+CONFIG  += console c++17
+CONFIG  -= app_bundle
+
+TARGET = musicool-widgetbench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../audioengine.cpp \
+    ../../audiosynth.cpp \
+    ../../clickbank.cpp \
+    ../../metronomeengine.cpp \
+    ../../metronomewidget.cpp \
+    ../../staffnotewidget.cpp \
+    ../../tunerwidget.cpp \
+    ../../wavfile.cpp
+
+HEADERS += \
+    ../../audioengine.h \
+    ../../audiosynth.h \
+    ../../clickbank.h \
+    ../../metronomeengine.h \
+    ../../metronomewidget.h \
+    ../../spscqueue.h \
+    ../../staffnotewidget.h \
+    ../../textcache.h \
+    ../../tunerwidget.h \
+    ../../wavfile.h
+
+# clave (sol.png) e sons de click
+RESOURCES += ../../stuff.qrc
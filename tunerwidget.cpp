@@ -1,11 +1,14 @@
 #include "tunerwidget.h"
 #include <QPainter>
 #include <QPaintEvent>
-#include <QPropertyAnimation>
-#include <QEasingCurve>
+#include <QScreen>
 #include <QtMath>
 #include <QPainterPath>           // <-- necessário
 #include <QRadialGradient>        // <-- (usa QRadialGradient no desenho)
+#include <QElapsedTimer>
+#include <QFontMetrics>
+#include <QVector>
+#include <QDebug>
 
 static double clampd(double v, double a, double b) {
     return v < a ? a : (v > b ? b : v);
@@ -18,9 +21,8 @@ TunerWidget::TunerWidget(QWidget* parent)
     setAutoFillBackground(false);
     setMinimumSize(320, 110);
 
-    m_anim = new QPropertyAnimation(this, "displayCents");
-    m_anim->setEasingCurve(QEasingCurve::OutCubic);
-    m_anim->setDuration(120);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &TunerWidget::stepNeedle);
 
     QPalette p = palette();
     p.setColor(QPalette::Window, m_bg);
@@ -35,29 +37,63 @@ void TunerWidget::setCents(double c)
     m_cents = c;
     emit centsChanged(c);
 
-    if (m_animEnabled) {
-        m_anim->stop();
-        m_anim->setStartValue(m_displayCents);
-        m_anim->setEndValue(c);
-        int dur = int(clampd(std::abs(m_displayCents - c) * 2.0, 60.0, 160.0));
-        m_anim->setDuration(dur);
-        m_anim->start();
-    } else {
-        setDisplayCents(c);
+    if (!m_animEnabled) { setDisplayCents(c); return; }
+
+    // a mola segue o alvo novo a partir da posição/velocidade atuais; várias
+    // leituras no mesmo frame viram um repaint só
+    if (!m_frameTimer.isActive()) {
+        const qreal hz = screen() ? screen()->refreshRate() : 60.0;
+        m_frameTimer.start(qMax(4, qRound(1000.0 / qBound(30.0, hz, 240.0))));
+        m_frameClock.start();
+    }
+}
+
+void TunerWidget::stepNeedle()
+{
+    // passo exato da mola criticamente amortecida (estável com qualquer dt):
+    // x(t) = alvo + (d + (v + w d) t) e^(-w t)
+    const double dt = qMin(0.05, m_frameClock.nsecsElapsed() / 1.0e9);
+    m_frameClock.start();
+
+    const double w = kSpringOmega;
+    const double d = m_displayCents - m_cents;
+    const double k = m_velocity + w * d;
+    const double e = std::exp(-w * dt);
+    double x = m_cents + (d + k * dt) * e;
+    m_velocity = (m_velocity - w * k * dt) * e;
+
+    // assentou: encosta no alvo e para de pedir frames
+    if (std::abs(x - m_cents) < 0.05 && std::abs(m_velocity) < 0.5) {
+        x = m_cents;
+        m_velocity = 0.0;
+        m_frameTimer.stop();
     }
+    setDisplayCents(x);
 }
 void TunerWidget::setDisplayCents(double c)
 {
     c = clampd(c, m_minCents, m_maxCents);
     if (qFuzzyCompare(m_displayCents, c)) return;
+
+    // só o que muda: bolinha na posição antiga e na nova + texto dos cents
+    QRegion dirty(indicatorRect(m_displayCents));
     m_displayCents = c;
     emit displayCentsChanged(c);
-    update();
+    dirty += indicatorRect(c);
+    if (m_showTopNote) dirty += centsRect();
+    update(dirty);
+}
+void TunerWidget::setMinCents(double v){ m_minCents=v; invalidateStatic(); }
+void TunerWidget::setMaxCents(double v){ m_maxCents=v; invalidateStatic(); }
+void TunerWidget::setSafeBandCents(double v){ m_safeBand=std::abs(v); invalidateStatic(); }
+void TunerWidget::setAnimationEnabled(bool on){
+    m_animEnabled = on;
+    if (!on) {
+        m_frameTimer.stop();
+        m_velocity = 0.0;
+        setDisplayCents(m_cents);
+    }
 }
-void TunerWidget::setMinCents(double v){ m_minCents=v; update(); }
-void TunerWidget::setMaxCents(double v){ m_maxCents=v; update(); }
-void TunerWidget::setSafeBandCents(double v){ m_safeBand=std::abs(v); update(); }
-void TunerWidget::setAnimationEnabled(bool on){ m_animEnabled=on; }
 void TunerWidget::setGlowEnabled(bool on){ m_glowEnabled=on; update(); }
 
 // ---------- setters (notas)
@@ -67,24 +103,48 @@ void TunerWidget::setBaseMidi(int midi){
     if (m_baseMidi == midi) return;
     m_baseMidi = midi;
     emit baseMidiChanged(m_baseMidi);
-    update();
+    update();                             // camada estática é refeita pela chave
 }
-void TunerWidget::setPreferSharps(bool v){ m_preferSharps=v; update(); }
-void TunerWidget::setShowOctave(bool v){ m_showOctave=v; update(); }
-void TunerWidget::setShowTopNote(bool v){ m_showTopNote=v; update(); }
-void TunerWidget::setShowNumericTicks(bool v){ m_showNumericTicks=v; update(); }
-void TunerWidget::setShowNoteMarkers(bool v){ m_showNoteMarkers=v; update(); }
+void TunerWidget::setPreferSharps(bool v){ m_preferSharps=v; m_textCache.invalidate(); invalidateStatic(); }
+void TunerWidget::setShowOctave(bool v){ m_showOctave=v; m_textCache.invalidate(); invalidateStatic(); }
+void TunerWidget::setShowTopNote(bool v){ m_showTopNote=v; invalidateStatic(); }
+void TunerWidget::setShowNumericTicks(bool v){ m_showNumericTicks=v; invalidateStatic(); }
+void TunerWidget::setShowNoteMarkers(bool v){ m_showNoteMarkers=v; invalidateStatic(); }
 
 // ---------- setters (paleta)
-void TunerWidget::setBackgroundColor(const QColor& c){ m_bg=c; update(); }
-void TunerWidget::setTrackColor(const QColor& c){ m_track=c; update(); }
-void TunerWidget::setTrackBorderColor(const QColor& c){ m_trackBorder=c; update(); }
-void TunerWidget::setSafeZoneColor(const QColor& c){ m_safe=c; update(); }
-void TunerWidget::setTickColor(const QColor& c){ m_tick=c; update(); }
-void TunerWidget::setTextColor(const QColor& c){ m_text=c; update(); }
+void TunerWidget::setBackgroundColor(const QColor& c){ m_bg=c; invalidateStatic(); }
+void TunerWidget::setTrackColor(const QColor& c){ m_track=c; invalidateStatic(); }
+void TunerWidget::setTrackBorderColor(const QColor& c){ m_trackBorder=c; invalidateStatic(); }
+void TunerWidget::setSafeZoneColor(const QColor& c){ m_safe=c; invalidateStatic(); }
+void TunerWidget::setTickColor(const QColor& c){ m_tick=c; invalidateStatic(); }
+void TunerWidget::setTextColor(const QColor& c){ m_text=c; invalidateStatic(); }
 void TunerWidget::setIndicatorColor(const QColor& c){ m_indicator=c; update(); }
 void TunerWidget::setGlowColor(const QColor& c){ m_glow=c; update(); }
-void TunerWidget::setNoteMarkerColor(const QColor& c){ m_noteMarker=c; update(); }
+void TunerWidget::setNoteMarkerColor(const QColor& c){ m_noteMarker=c; invalidateStatic(); }
+
+// ---------- cache
+void TunerWidget::setStaticCacheEnabled(bool on)
+{
+    m_cacheEnabled = on;
+    if (!on) m_static = QPixmap();
+    invalidateStatic();
+}
+
+void TunerWidget::invalidateStatic()
+{
+    m_staticDirty = true;
+    update();
+}
+
+void TunerWidget::changeEvent(QEvent* e)
+{
+    if (e->type() == QEvent::FontChange || e->type() == QEvent::PaletteChange
+        || e->type() == QEvent::StyleChange) {
+        if (e->type() == QEvent::FontChange) m_textCache.invalidate();
+        invalidateStatic();
+    }
+    QWidget::changeEvent(e);
+}
 
 // ---------- helpers
 QRectF TunerWidget::trackRect() const
@@ -101,27 +161,93 @@ double TunerWidget::valueToRatio(double c) const
     if (range <= 0.0) return 0.5;
     return (c - m_minCents) / range;
 }
+QRect TunerWidget::indicatorRect(double cents) const
+{
+    // mesma geometria de paintLive(); +2 px para borda e antialias
+    const QRectF tr = trackRect();
+    const qreal x = tr.left() + valueToRatio(cents) * tr.width();
+    const qreal R = tr.height()*0.48 + 2.0;
+    return QRectF(x - R, tr.center().y() - R, 2*R, 2*R).toAlignedRect();
+}
+const QFont& TunerWidget::centsFont() const
+{
+    return m_textCache.font(kCentsFont, font(), qMax(9.0, height()*0.09));
+}
+QRect TunerWidget::centsRect() const
+{
+    centsFont();
+    const int w = qCeil(m_textCache.text(kCentsFont, kCentsWidest, []{
+                            return QStringLiteral("-50.0 ¢"); }).size().width()) + 8;
+    const qreal top = trackRect().top() - 2 - height()*0.05;
+    return QRectF(width()/2.0 - w/2.0, top, w, height()*0.12).toAlignedRect();
+}
 QString TunerWidget::noteNameForMidi(int midi, bool preferSharps, bool withOctave)
 {
-    static const char* sharpNames[12] = {"C","C♯","D","D♯","E","F",
-                                         "F♯","G","G♯","A","A♯","B"};
-    static const char* flatNames [12] = {"C","D♭","D","E♭","E","F",
-                                        "G♭","G","A♭","A","B♭","B"};
+    // as 4 grafias x 128 notas, montadas uma vez (QString é compartilhada)
+    static const QVector<QString> names = []{
+        static const char* sharpNames[12] = {"C","C♯","D","D♯","E","F",
+                                             "F♯","G","G♯","A","A♯","B"};
+        static const char* flatNames [12] = {"C","D♭","D","E♭","E","F",
+                                            "G♭","G","A♭","A","B♭","B"};
+        QVector<QString> t(4 * 128);
+        for (int v = 0; v < 4; ++v)
+            for (int m = 0; m < 128; ++m) {
+                QString s = QString::fromUtf8((v & 1) ? sharpNames[m % 12] : flatNames[m % 12]);
+                if (v & 2) s += QString::number(m / 12 - 1);
+                t[v * 128 + m] = s;
+            }
+        return t;
+    }();
     if (midi < 0) midi = 0; if (midi > 127) midi = 127;
-    int pc = midi % 12;
-    int oct = midi / 12 - 1;
-    const char* base = preferSharps ? sharpNames[pc] : flatNames[pc];
-    QString s = QString::fromUtf8(base);
-    if (withOctave) s += QString::number(oct);
-    return s;
+    return names.at(((preferSharps ? 1 : 0) + (withOctave ? 2 : 0)) * 128 + midi);
+}
+const QStaticText& TunerWidget::noteText(int slot, int midi)
+{
+    midi = qBound(0, midi, 127);
+    return m_textCache.text(slot, midi, [this, midi]{
+        return noteNameForMidi(midi, m_preferSharps, m_showOctave); });
 }
 
 // ---------- paint
-void TunerWidget::paintEvent(QPaintEvent*)
+void TunerWidget::paintEvent(QPaintEvent* e)
 {
+    // WA_OpaquePaintEvent: só a região suja precisa ser coberta
+    const QRegion dirty = e->region();
+    m_textCache.checkDpr(devicePixelRatioF());
     QPainter g(this);
+    if (m_cacheEnabled) {
+        ensureStatic();
+        const qreal dpr = m_static.devicePixelRatio();
+        for (const QRect& r : dirty)
+            g.drawPixmap(r, m_static, QRectF(QPointF(r.topLeft()) * dpr, QSizeF(r.size()) * dpr));
+    } else {
+        g.setRenderHint(QPainter::Antialiasing, true);
+        paintStatic(g);
+    }
     g.setRenderHint(QPainter::Antialiasing, true);
+    paintLive(g, dirty);
+}
+
+void TunerWidget::ensureStatic()
+{
+    // chave: tamanho em pixels do device + nota (o resto marca m_staticDirty)
+    const qreal dpr = devicePixelRatioF();
+    const QSize px = (QSizeF(size()) * dpr).toSize();
+    if (!m_staticDirty && m_static.size() == px && qFuzzyCompare(m_static.devicePixelRatio(), dpr)
+        && m_staticMidi == m_baseMidi)
+        return;
 
+    m_static = QPixmap(px);
+    m_static.setDevicePixelRatio(dpr);
+    QPainter p(&m_static);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    paintStatic(p);
+    m_staticMidi  = m_baseMidi;
+    m_staticDirty = false;
+}
+
+void TunerWidget::paintStatic(QPainter& g)
+{
     // fundo
     g.fillRect(rect(), m_bg);
 
@@ -151,54 +277,60 @@ void TunerWidget::paintEvent(QPaintEvent*)
 
     // ticks numéricos
     if (m_showNumericTicks) {
-        auto drawTick = [&](double val, int len, int thick, const QString& label){
+        g.setFont(m_textCache.font(kTickFont, font(), qMax(9.0, height()*0.07)));
+        auto drawTick = [&](int val, int len, int thick){
             const double r = valueToRatio(val);
             const qreal x = tr.left() + r * tr.width();
             QPen pen(m_tick, thick);
             pen.setCosmetic(true);
             g.setPen(pen);
             g.drawLine(QPointF(x, tr.bottom()+6), QPointF(x, tr.bottom()+6+len));
-            if (!label.isEmpty()) {
-                QFont f = font(); f.setPointSizeF(qMax(9.0, height()*0.07));
-                g.setFont(f);
-                g.setPen(m_text);
-                QRectF tb(x-40, tr.bottom()+8+len, 80, height()*0.18);
-                g.drawText(tb, Qt::AlignHCenter|Qt::AlignTop, label);
-            }
+            g.setPen(m_text);
+            QRectF tb(x-40, tr.bottom()+8+len, 80, height()*0.18);
+            TextCache::draw(g, tb, Qt::AlignHCenter|Qt::AlignTop,
+                            m_textCache.text(kTickFont, val, [val]{ return QString::number(val); }));
         };
-        drawTick(-50, 10, 2, "-50");
-        drawTick(-25, 7,  1, "-25");
-        drawTick(  0, 14, 3,  "0");
-        drawTick( 25, 7,  1, "25");
-        drawTick( 50, 10, 2, "50");
+        drawTick(-50, 10, 2);
+        drawTick(-25, 7,  1);
+        drawTick(  0, 14, 3);
+        drawTick( 25, 7,  1);
+        drawTick( 50, 10, 2);
     }
 
     // marcadores de NOTA (−50 / 0 / +50)
     if (m_showNoteMarkers) {
-        const QString leftNote  = noteNameForMidi(m_baseMidi - 1, m_preferSharps, m_showOctave);
-        const QString midNote   = noteNameForMidi(m_baseMidi,     m_preferSharps, m_showOctave);
-        const QString rightNote = noteNameForMidi(m_baseMidi + 1, m_preferSharps, m_showOctave);
-
-        auto drawLabel = [&](double val, const QString& text, bool emphasize){
+        auto drawLabel = [&](double val, int midi, bool emphasize){
             const double r = valueToRatio(val);
             const qreal x = tr.left() + r * tr.width();
-            QFont f = font();
-            f.setBold(emphasize);
-            f.setPointSizeF(qMax(10.0, height() * (emphasize ? 0.12 : 0.095)));
-            g.setFont(f);
+            const int slot = emphasize ? kMarkerBoldFont : kMarkerFont;
+            g.setFont(m_textCache.font(slot, font(),
+                                       qMax(10.0, height() * (emphasize ? 0.12 : 0.095)), emphasize));
             g.setPen(emphasize ? m_noteMarker : m_noteMarker.darker(135));
             QRectF box(x-60, tr.top()-height()*0.22, 120, height()*0.18);
-            g.drawText(box, Qt::AlignHCenter|Qt::AlignBottom, text);
+            TextCache::draw(g, box, Qt::AlignHCenter|Qt::AlignBottom, noteText(slot, midi));
         };
 
-        drawLabel(-50, leftNote,  false);
+        drawLabel(-50, m_baseMidi - 1, false);
         if (!m_showTopNote)       // << evita sobrepor com o título grande
-            drawLabel(  0, midNote,   true);
-        drawLabel( 50, rightNote, false);
+            drawLabel(  0, m_baseMidi, true);
+        drawLabel( 50, m_baseMidi + 1, false);
     }
 
+    // topo: nota grande
+    if (m_showTopNote) {
+        g.setFont(m_textCache.font(kTopFont, font(), qMax(12.0, height()*0.16), true));
+        g.setPen(m_text);
+        QRectF nbox(0, rect().top()+4, rect().width(), trackRect().top()-rect().top()-6);
+        TextCache::draw(g, nbox, Qt::AlignHCenter|Qt::AlignVCenter, noteText(kTopFont, m_baseMidi));
+    }
+}
+
+void TunerWidget::paintLive(QPainter& g, const QRegion& dirty)
+{
+    const QRectF tr = trackRect();
+
     // indicador (bolinha)
-    {
+    if (dirty.intersects(indicatorRect(m_displayCents))) {
         const double r = valueToRatio(m_displayCents);
         qreal x = tr.left() + r * tr.width();
         qreal y = tr.center().y();
@@ -230,21 +362,16 @@ void TunerWidget::paintEvent(QPaintEvent*)
         g.drawEllipse(QPointF(x,y), R, R);
     }
 
-    // topo: nota grande + cents (opcional)
-    if (m_showTopNote) {
-        const QString midNote = noteNameForMidi(m_baseMidi, m_preferSharps, m_showOctave);
-        QFont f = font(); f.setBold(true);
-        f.setPointSizeF(qMax(12.0, height()*0.16));
-        g.setFont(f);
+    // cents pequeno abaixo da nota grande (opcional)
+    if (m_showTopNote && dirty.intersects(centsRect())) {
+        const QRectF nbox(0, rect().top()+4, rect().width(), tr.top()-rect().top()-6);
+        g.setFont(centsFont());
         g.setPen(m_text);
-        QRectF nbox(0, rect().top()+4, rect().width(), trackRect().top()-rect().top()-6);
-        g.drawText(nbox, Qt::AlignHCenter|Qt::AlignVCenter, midNote);
-
-        // cents pequeno ao lado (ou abaixo)
-        QFont f2 = font(); f2.setPointSizeF(qMax(9.0, height()*0.09));
-        g.setFont(f2);
-        const QString centsStr = QString::number(m_displayCents, 'f', 1) + " ¢";
+        // décimos de cent como chave: o texto de cada valor é montado uma vez
+        const int tenths = qRound(m_displayCents * 10.0);
+        const QStaticText& st = m_textCache.text(kCentsFont, tenths, [tenths]{
+            return QString::number(tenths / 10.0, 'f', 1) + QStringLiteral(" ¢"); });
         QRectF cbox(0, nbox.bottom()-height()*0.05, rect().width(), height()*0.12);
-        g.drawText(cbox, Qt::AlignHCenter|Qt::AlignTop, centsStr);
+        TextCache::draw(g, cbox, Qt::AlignHCenter|Qt::AlignTop, st);
     }
 }
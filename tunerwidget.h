@@ -1,7 +1,10 @@
 #pragma once
 #include <QWidget>
 #include <QColor>
-class QPropertyAnimation;
+#include <QPixmap>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "textcache.h"
 
 class TunerWidget : public QWidget
 {
@@ -65,6 +68,13 @@ public:
     QColor glowColor() const { return m_glow; }
     QColor noteMarkerColor() const { return m_noteMarker; }
 
+    // Fundo, trilho, faixa segura, ticks e nomes de nota ficam num pixmap
+    // na resolução do device (refeito ao mudar tamanho, paleta ou nota);
+    // por frame só o indicador, o glow e os cents. Desligar = medir o antes
+    // (tools/musicool-widgetbench compara os dois).
+    void setStaticCacheEnabled(bool on);
+    bool staticCacheEnabled() const { return m_cacheEnabled; }
+
 public slots:
     // valores
     void setCents(double c);
@@ -102,11 +112,28 @@ signals:
 protected:
     QSize sizeHint() const override { return {560, 180}; }
     void paintEvent(QPaintEvent*) override;
+    void changeEvent(QEvent* e) override;
 
 private:
+    void paintStatic(QPainter& g);         // não depende de displayCents
+    void paintLive(QPainter& g, const QRegion& dirty);   // indicador, glow e cents
+    void ensureStatic();
+    void stepNeedle();                     // um frame da mola
+    void invalidateStatic();               // paleta/flags mudaram
+
     QRectF trackRect() const;
+    QRect  indicatorRect(double cents) const;   // bolinha + glow + borda
+    QRect  centsRect() const;              // texto dos cents (pior caso)
+    const QFont& centsFont() const;
     double valueToRatio(double c) const;   // 0..1
     static QString noteNameForMidi(int midi, bool preferSharps, bool withOctave);
+    const QStaticText& noteText(int slot, int midi);
+
+    // texto: fontes e QStaticText por slot (nomes das 128 notas, cents em
+    // décimos, rótulos dos ticks); refeito só em resize/DPR/fonte/grafia
+    enum TextSlot { kTickFont, kMarkerFont, kMarkerBoldFont, kTopFont, kCentsFont };
+    static constexpr int kCentsWidest = 1 << 30;   // "-50.0 ¢", mede centsRect()
+    mutable TextCache m_textCache;
 
     // estado
     double m_minCents = -50.0;
@@ -123,9 +150,13 @@ private:
     bool m_showNumericTicks = true;
     bool m_showNoteMarkers = true;
 
-    // animação
+    // animação: mola criticamente amortecida, um passo por frame; os
+    // resultados do tracker só mudam o alvo (m_cents)
+    static constexpr double kSpringOmega = 45.0;   // rad/s (~150 ms até assentar)
     bool m_animEnabled = true;
-    QPropertyAnimation* m_anim = nullptr;
+    double m_velocity = 0.0;               // cents/s
+    QTimer m_frameTimer;
+    QElapsedTimer m_frameClock;
 
     // visual
     bool   m_glowEnabled = true;
@@ -138,4 +169,10 @@ private:
     QColor m_indicator{0x4f,0x8a,0xff};
     QColor m_glow{0x4f,0x8a,0xff};
     QColor m_noteMarker{0xff,0xff,0xff};
+
+    // camada estática em cache
+    bool    m_cacheEnabled = true;
+    bool    m_staticDirty  = true;
+    QPixmap m_static;
+    int     m_staticMidi   = -1;           // baseMidi com que foi desenhada
 };
@@ -0,0 +1,125 @@
+#include "wavfile.h"
+#include <QtEndian>
+#include <cstring>
+
+static void putLE32(char* p, quint32 v) { qToLittleEndian<quint32>(v, p); }
+static void putLE16(char* p, quint16 v) { qToLittleEndian<quint16>(v, p); }
+static quint32 getLE32(const char* p) { return qFromLittleEndian<quint32>(p); }
+static quint16 getLE16(const char* p) { return qFromLittleEndian<quint16>(p); }
+
+bool WavWriter::open(const QString& path, int sampleRate, int channels)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    m_sampleRate = qMax(1, sampleRate);
+    m_channels   = qBound(1, channels, 8);
+    m_frames     = 0;
+    return writeHeader(0); // tamanhos corrigidos no close()
+}
+
+bool WavWriter::write(const qint16* frames, qint64 frameCount)
+{
+    if (!m_file.isOpen() || frameCount <= 0) return m_file.isOpen();
+
+    const qint64 bytes = frameCount * m_channels * qint64(sizeof(qint16));
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    QByteArray tmp(int(bytes), Qt::Uninitialized);
+    qToLittleEndian<qint16>(frames, frameCount * m_channels, tmp.data());
+    if (m_file.write(tmp) != bytes) return false;
+#else
+    if (m_file.write(reinterpret_cast<const char*>(frames), bytes) != bytes) return false;
+#endif
+    m_frames += frameCount;
+    return true;
+}
+
+bool WavWriter::close()
+{
+    if (!m_file.isOpen()) return true;
+
+    const qint64 dataBytes = m_frames * m_channels * qint64(sizeof(qint16));
+    bool ok = m_file.seek(0) && writeHeader(quint32(qMin<qint64>(dataBytes, 0xFFFFFFFFLL - 36)));
+    m_file.close();
+    return ok;
+}
+
+bool WavWriter::writeHeader(quint32 dataBytes)
+{
+    const quint16 blockAlign = quint16(m_channels * sizeof(qint16));
+    char h[44];
+    memcpy(h +  0, "RIFF", 4); putLE32(h +  4, 36 + dataBytes);
+    memcpy(h +  8, "WAVE", 4);
+    memcpy(h + 12, "fmt ", 4); putLE32(h + 16, 16);
+    putLE16(h + 20, 1);                       // PCM
+    putLE16(h + 22, quint16(m_channels));
+    putLE32(h + 24, quint32(m_sampleRate));
+    putLE32(h + 28, quint32(m_sampleRate) * blockAlign);
+    putLE16(h + 32, blockAlign);
+    putLE16(h + 34, 16);                      // bits por sample
+    memcpy(h + 36, "data", 4); putLE32(h + 40, dataBytes);
+    return m_file.write(h, sizeof(h)) == qint64(sizeof(h));
+}
+
+// ---------------- WavReader ----------------
+bool WavReader::load(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return fail(f.errorString());
+    const QByteArray raw = f.readAll();
+    const char* p = raw.constData();
+    const qint64 size = raw.size();
+
+    if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0)
+        return fail("nao e um arquivo WAV");
+
+    // percorre os chunks: "fmt " antes de "data"; o resto é ignorado
+    int format = 0, channels = 0, bits = 0;
+    const char* data = nullptr;
+    qint64 dataBytes = 0;
+    for (qint64 off = 12; off + 8 <= size; ) {
+        const quint32 len = getLE32(p + off + 4);
+        const char* body = p + off + 8;
+        const qint64 avail = qMin<qint64>(len, size - off - 8);
+        if (memcmp(p + off, "fmt ", 4) == 0 && avail >= 16) {
+            format     = getLE16(body);
+            channels   = getLE16(body + 2);
+            m_sampleRate = int(getLE32(body + 4));
+            bits       = getLE16(body + 14);
+            if (format == 0xFFFE && avail >= 26) format = getLE16(body + 24); // extensible
+        } else if (memcmp(p + off, "data", 4) == 0) {
+            data = body;
+            dataBytes = avail;
+            break;
+        }
+        off += 8 + len + (len & 1);   // chunks alinhados em 2 bytes
+    }
+
+    if (!data || channels < 1 || m_sampleRate <= 0) return fail("WAV sem fmt/data");
+    const bool isFloat = (format == 3 && bits == 32);
+    if (!(format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32)) && !isFloat)
+        return fail(QString("formato WAV nao suportado (%1, %2 bits)").arg(format).arg(bits));
+
+    const int bps = bits / 8;
+    const qint64 frames = dataBytes / (bps * channels);
+    m_mono.resize(int(frames));
+    for (qint64 i = 0; i < frames; ++i) {
+        double acc = 0.0;
+        for (int c = 0; c < channels; ++c) {
+            const char* s = data + (i * channels + c) * bps;
+            switch (bits) {
+            case 8:  acc += (quint8(*s) - 128) / 128.0; break;
+            case 16: acc += qint16(getLE16(s)) / 32768.0; break;
+            case 24: acc += (qint32(quint32(quint8(s[0])) << 8 | quint32(quint8(s[1])) << 16
+                                    | quint32(quint8(s[2])) << 24) >> 8) / 8388608.0; break;
+            default:
+                if (isFloat) { float v; quint32 u = getLE32(s); memcpy(&v, &u, 4); acc += v; }
+                else         acc += qint32(getLE32(s)) / 2147483648.0;
+            }
+        }
+        m_mono[int(i)] = float(acc / channels);
+    }
+    m_error.clear();
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// Escrita de WAV (PCM 16-bit) em streaming: o cabeçalho é gravado com
+// tamanhos provisórios e corrigido no close(), então dá para gerar
+// arquivos longos sem manter o áudio inteiro em memória.
+class WavWriter
+{
+public:
+    WavWriter() = default;
+    ~WavWriter() { close(); }
+
+    bool open(const QString& path, int sampleRate, int channels = 1);
+    bool write(const qint16* frames, qint64 frameCount);
+    bool close();
+
+    bool    isOpen() const       { return m_file.isOpen(); }
+    qint64  framesWritten() const { return m_frames; }
+    QString errorString() const  { return m_file.errorString(); }
+
+private:
+    bool writeHeader(quint32 dataBytes);
+
+    QFile  m_file;
+    int    m_sampleRate = 44100;
+    int    m_channels   = 1;
+    qint64 m_frames     = 0;
+};
+
+// Leitura de WAV (PCM 8/16/24/32-bit ou float 32-bit, qualquer nº de
+// canais) para mono em float [-1, 1]. Aceita caminhos de recurso (":/...").
+// Feito para amostras curtas: o arquivo inteiro vai para a memória.
+class WavReader
+{
+public:
+    bool load(const QString& path);
+
+    int sampleRate() const               { return m_sampleRate; }
+    const QVector<float>& mono() const   { return m_mono; }
+    QString errorString() const          { return m_error; }
+
+private:
+    bool fail(const QString& why) { m_error = why; m_mono.clear(); return false; }
+
+    int            m_sampleRate = 0;
+    QVector<float> m_mono;
+    QString        m_error;
+};